@@ -71,6 +71,8 @@
 #define __r_nonnull__(...)        __attribute__((nonnull (__VA_ARGS__)))
 #define __r_returns_nonnull__     __attribute__((returns_nonnull))
 #define __r_noreturn__            __attribute__((noreturn))
+#define __r_packed__              __attribute__((packed))
+#define __r_aligned__(x)          __attribute__((aligned(x)))
 #define __r_unused__              __attribute__((unused))
 #define __r_visibility__(x)       __attribute__((visibility(x)))
 
@@ -101,6 +103,8 @@
 #define __r_nonnull__(...)
 #define __r_returns_nonnull__
 #define __r_noreturn__
+#define __r_packed__
+#define __r_aligned__(x)
 #define __r_unused__
 #define __r_visibility__(x)
 
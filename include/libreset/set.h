@@ -35,12 +35,25 @@ struct r_set;
 
 /**
  * Set configuration type
+ *
+ * The memory used by a set internally is requested from `allocf` and returned
+ * via `deallocf`, both of which are passed `alloc_etc` along with the size of
+ * the memory. The memory returned by `allocf` must be suitably aligned for any
+ * type. If `allocf` and `deallocf` are NULL, malloc() and free() are used.
+ * Either both or none of them must be provided.
+ *
+ * The allocation functions are not taken into account when comparing the
+ * configurations of sets. The sets in a set operation may hence use different
+ * allocators.
  */
 struct r_set_cfg {
     r_hash         (*hashf)(void const* data); //!< hash function
     int             (*cmpf)(void const*, void const*); //!< compare function
     void*           (*copyf)(void*); //!< copy function
     void            (*freef)(void*); //!< function for removal/freeing of an item
+    void*           (*allocf)(void*, size_t); //!< allocation function
+    void            (*deallocf)(void*, void*, size_t); //!< deallocation function
+    void*           alloc_etc; //!< user data passed to allocf and deallocf
 };
 
 
@@ -84,9 +97,177 @@ __r_nonnull__(1)
 ;
 
 
+/**
+ * Allocate and initialize set object for an expected number of elements
+ *
+ * The set is created with enough buckets to hold `n` elements without growing.
+ *
+ * @memberof r_set
+ *
+ * @return A pointer to the set object or NULL on failure
+ */
+struct r_set*
+r_set_new_with_capacity(
+    struct r_set_cfg const* cfg, //!< configuration for the set object
+    size_t n //!< expected number of elements
+)
+__r_nonnull__(1)
+;
+
+
+/**
+ * Allocate a set object holding the elements of an array
+ *
+ * The set is built in time linear in `n`, see r_set_insert_bulk(). Duplicates
+ * within `elems` are only inserted once.
+ *
+ * @memberof r_set
+ *
+ * @return A pointer to the set object or NULL on failure, in which case the
+ *         elements are not freed
+ */
+struct r_set*
+r_set_from_array(
+    struct r_set_cfg const* cfg, //!< configuration for the set object
+    void* const* elems, //!< The elements to put in the set
+    size_t n //!< The number of elements in `elems`
+)
+__r_nonnull__(1)
+;
+
+
+/**
+ * Prepare a set for holding an expected number of elements
+ *
+ * The set is grown in one step, rather than gradually while being filled.
+ * Sets never shrink below the reserved capacity.
+ *
+ * @memberof r_set
+ *
+ * @return 0 on success, else errno const:
+ *         -ENOMEM - on allocation failed
+ *         -EPERM - if the set is frozen
+ *         -EBUSY - if a bulk session is in progress on the set
+ */
+int
+r_set_reserve(
+    struct r_set* set, //!< Set to reserve capacity in
+    size_t n //!< expected number of elements
+)
+__r_nonnull__(1)
+;
+
+
+/**
+ * Turn a set into an immutable one
+ *
+ * The elements of each bucket are copied into two contiguous arrays: their
+ * hashes, laid out as an implicit binary search tree in breadth first order
+ * (Eytzinger layout), and the elements themselves, in the same order. The
+ * nodes the set was built from are released. Lookups in a frozen set descend
+ * the array of hashes without branching on the comparisons, prefetching the
+ * entries they will visit next, and do not follow any pointers.
+ *
+ * A frozen set can not be modified any more. It may still be queried,
+ * selected from and used as an operand of any set operation, but not as the
+ * destination. If the set is already frozen, nothing is done.
+ *
+ * @memberof r_set
+ *
+ * @return 0 on success, else errno const:
+ *         -ENOMEM - if allocation failed, in which case the set is unchanged
+ *         -EBUSY - if a bulk session is in progress on the set
+ */
+int
+r_set_freeze(
+    struct r_set* set //!< Set to freeze
+)
+__r_nonnull__(1)
+;
+
+
+/**
+ * Rearrange the internal nodes of a set in memory
+ *
+ * After many insertions and removals, the nodes of a set are scattered over
+ * the chunks they were allocated from. Compacting a set copies its nodes to
+ * new chunks, bucket by bucket and in ascending order of the hashes, so that
+ * lookups and iterations touch fewer cache lines and pages. The trees are
+ * balanced perfectly along the way and the chunks the nodes were copied from
+ * are released. The elements themselves are not moved.
+ *
+ * Unlike a frozen set, a compacted set remains mutable. While compacting, the
+ * old and the new nodes are held at the same time. If the set is frozen,
+ * nothing is done.
+ *
+ * @memberof r_set
+ *
+ * @return 0 on success, else errno const:
+ *         -ENOMEM - if allocation failed, in which case the set is unchanged
+ *         -EBUSY - if a bulk session is in progress on the set
+ */
+int
+r_set_compact(
+    struct r_set* set //!< Set to compact
+)
+__r_nonnull__(1)
+;
+
+
+/**
+ * Start a bulk session on a set
+ *
+ * Applying a large batch of insertions and removals one by one rebalances the
+ * trees of the set after each of them. Within a bulk session, r_set_insert()
+ * and r_set_remove() only link and unlink the nodes holding the elements.
+ * Each tree touched is rebalanced once, when r_set_end_bulk() is called, and
+ * the set is not resized before that either. As the trees touched are rebuilt
+ * as a whole, a session pays off for batches in the order of the number of
+ * elements in the set or beyond, rather than for a few elements.
+ *
+ * During the session, the set may still be queried and used as an operand of
+ * set operations, though lookups may be slower. Any other modification of the
+ * set fails with -EBUSY. If a session is in progress already, nothing is done.
+ *
+ * @memberof r_set
+ *
+ * @return 0 on success, else errno const:
+ *         -ENOMEM - if allocation failed
+ *         -EPERM - if the set is frozen
+ */
+int
+r_set_begin_bulk(
+    struct r_set* set //!< Set to start the session for
+)
+__r_nonnull__(1)
+;
+
+
+/**
+ * End a bulk session on a set
+ *
+ * The trees modified during the session are rebalanced, and the set is grown
+ * or shrunk for the number of elements it holds now. If no session is in
+ * progress on the set, nothing is done.
+ *
+ * @memberof r_set
+ */
+void
+r_set_end_bulk(
+    struct r_set* set //!< Set to end the session for
+)
+__r_nonnull__(1)
+;
+
+
 /**
  * Remove a set object from memory
  *
+ * The internal nodes of a set are allocated in chunks, which are released as a
+ * whole. Only if the configuration provides a `freef`, each element is visited
+ * in order to free it. Otherwise, the cost of destroying a set depends on the
+ * number of chunks rather than on the number of elements.
+ *
  * @memberof r_set
  *
  * @return 0 on success, else errno const:
@@ -106,6 +287,7 @@ __r_nonnull__(1)
  * @return zero on success, else error code (errno.h):
  *         -ENOMEM - on allocation failed
  *         -EEXIST - if the element is already in the set
+ *         -EPERM - if the set is frozen
  */
 int
 r_set_insert(
@@ -115,6 +297,30 @@ r_set_insert(
 __r_nonnull__(1)
 ;
 
+
+/**
+ * Insert the objects of an array into a set
+ *
+ * Rather than inserting the elements one by one, they are sorted by their
+ * hashes, and each tree of the set is rebuilt only once, perfectly balanced.
+ * Elements which are already in the set, as well as duplicates within `elems`,
+ * are skipped without an error.
+ *
+ * @return zero on success, else error code (errno.h):
+ *         -ENOMEM - on allocation failed, in which case only some of the
+ *                   elements may have been inserted
+ *         -EPERM - if the set is frozen
+ *         -EBUSY - if a bulk session is in progress on the set
+ */
+int
+r_set_insert_bulk(
+    struct r_set* set, //!< the set
+    void* const* elems, //!< the values to insert
+    size_t n //!< the number of values in `elems`
+)
+__r_nonnull__(1)
+;
+
 /**
  * Remove an object from the set
  *
@@ -122,6 +328,7 @@ __r_nonnull__(1)
  *
  * @return 0 (zero) on success and errno const:
  *         -EEXIST - if the element was not found in the set
+ *         -EPERM - if the set is frozen
  */
 int
 r_set_remove(
@@ -135,6 +342,9 @@ __r_nonnull__(1, 2)
 /**
  * Check if a set contains an object
  *
+ * The set is not modified. In particular, a resize of the set in progress is
+ * only advanced by insertions and removals, not by lookups.
+ *
  * @memberof r_set
  *
  * @return The object if it is in the set, else NULL
@@ -151,10 +361,18 @@ __r_nonnull__(1, 2)
 /**
  * Compute union out of two sets
  *
+ * All elements of `set_a` and `set_b` are added to `dest`. `dest` may be one of
+ * the operands. All three sets must have equal configurations.
+ *
+ * The union is computed bucket by bucket, without computing any hashes.
+ *
  * @memberof r_set
  *
  * @return zero on success, else error code:
  *         -ENOMEM - if allocation failed
+ *         -EINVAL - if the configurations of the sets differ
+ *         -EPERM - if `dest` is frozen
+ *         -EBUSY - if a bulk session is in progress on `dest`
  */
 int
 r_set_union(
@@ -168,10 +386,23 @@ __r_nonnull__(1, 2, 3)
 /**
  * Compute intersection of two sets
  *
+ * All elements which are in both `set_a` and `set_b` are added to `dest`. All
+ * three sets must have equal configurations.
+ *
+ * The intersection is computed bucket by bucket. Subtrees of the buckets are
+ * skipped as soon as their bloom filters prove them disjoint.
+ *
+ * `dest` may be one of the operands. In this case, the elements which are not
+ * in the other operand are removed from `dest` in place, without allocating
+ * another set.
+ *
  * @memberof r_set
  *
  * @return zero on success, else error code:
  *         -ENOMEM - if allocation failed
+ *         -EINVAL - if the configurations of the sets differ
+ *         -EPERM - if `dest` is frozen
+ *         -EBUSY - if a bulk session is in progress on `dest`
  */
 int
 r_set_intersection(
@@ -182,13 +413,84 @@ r_set_intersection(
 __r_nonnull__(1, 2, 3)
 ;
 
+/**
+ * Compute union out of several sets
+ *
+ * All elements of the `n` sets in `sets` are added to `dest`. `dest` may be
+ * one of the operands. All sets must have equal configurations.
+ *
+ * The elements of all the operands are merged into each bucket of `dest` at
+ * once, without any intermediate sets.
+ *
+ * @memberof r_set
+ *
+ * @return zero on success, else error code:
+ *         -ENOMEM - if allocation failed
+ *         -EINVAL - if the configurations of the sets differ
+ *         -EPERM - if `dest` is frozen
+ *         -EBUSY - if a bulk session is in progress on `dest`
+ */
+int
+r_set_union_n(
+    struct r_set* dest, //!< destination of the result
+    struct r_set const* const* sets, //!< arguments of the operation
+    size_t n //!< number of arguments
+)
+__r_nonnull__(1)
+;
+
+/**
+ * Compute intersection of several sets
+ *
+ * All elements which are in each of the `n` sets in `sets` are added to `dest`.
+ * All sets must have equal configurations.
+ *
+ * The buckets of all the operands are walked at once, taking the elements from
+ * the operand with the fewest elements. A subtree is skipped as soon as the
+ * bloom filters of the operands prove that there are no common elements.
+ *
+ * `dest` may be one of the operands. In this case, the elements which are not
+ * in the other operands are removed from `dest` in place.
+ *
+ * @memberof r_set
+ *
+ * @return zero on success, else error code:
+ *         -ENOMEM - if allocation failed
+ *         -EINVAL - if the configurations of the sets differ or if no set was
+ *                   passed
+ *         -EPERM - if `dest` is frozen
+ *         -EBUSY - if a bulk session is in progress on `dest`
+ */
+int
+r_set_intersection_n(
+    struct r_set* dest, //!< destination of the result
+    struct r_set const* const* sets, //!< arguments of the operation
+    size_t n //!< number of arguments
+)
+__r_nonnull__(1)
+;
+
 /**
  * Compute set with elements which are in only one of the two arguments
  *
+ * All elements which are in exactly one of `set_a` and `set_b` are added to
+ * `dest`. All three sets must have equal configurations.
+ *
+ * The symmetric difference is computed bucket by bucket. Subtrees of the
+ * buckets are copied without any lookup as soon as their bloom filters prove
+ * them disjoint from the other operand.
+ *
+ * `dest` may be one of the operands. In this case, the common elements are
+ * removed from `dest` in place. Only the elements missing from `dest` are
+ * collected before they are added.
+ *
  * @memberof r_set
  *
  * @return zero on success, else error code:
  *         -ENOMEM - if allocation failed
+ *         -EINVAL - if the configurations of the sets differ
+ *         -EPERM - if `dest` is frozen
+ *         -EBUSY - if a bulk session is in progress on `dest`
  */
 int
 r_set_xor(
@@ -202,10 +504,24 @@ __r_nonnull__(1, 2, 3)
 /**
  * Exclude elements from set_a which are in set_b
  *
+ * All elements of `set_a` which are not in `set_b` are added to `dest`. All
+ * three sets must have equal configurations.
+ *
+ * The difference is computed bucket by bucket. Subtrees of the buckets of
+ * `set_a` are copied without any lookup as soon as their bloom filters prove
+ * them disjoint from `set_b`.
+ *
+ * `dest` may be `set_a`. In this case, the elements of `set_b` are removed from
+ * `dest` in place, without allocating another set.
+ *
  * @memberof r_set
  *
  * @return zero on success, else error code:
  *         -ENOMEM - if allocation failed
+ *         -EINVAL - if the configurations of the sets differ or if `dest` is
+ *                   `set_b` but not `set_a`
+ *         -EPERM - if `dest` is frozen
+ *         -EBUSY - if a bulk session is in progress on `dest`
  */
 int
 r_set_exclude(
@@ -216,11 +532,104 @@ r_set_exclude(
 __r_nonnull__(1, 2, 3)
 ;
 
+/**
+ * Get the cardinality of the union of two sets
+ *
+ * The result is derived from the cardinalities of the sets and the number of
+ * their common elements, which is counted like r_set_intersection_cardinality()
+ * does. No memory is allocated.
+ *
+ * @memberof r_set
+ *
+ * @note Checks metainformation of the set objects first (comparator function,
+ * hashing function). If they are not equal, the sets are considered to have no
+ * common elements.
+ *
+ * @return the number of elements which are in `set_a` or `set_b`
+ */
+size_t
+r_set_union_cardinality(
+    struct r_set const* set_a, //!< first argument of the binary operation
+    struct r_set const* set_b //!< second argument of the binary operation
+)
+__r_nonnull__(1, 2)
+;
+
+/**
+ * Get the cardinality of the intersection of two sets
+ *
+ * The common elements are counted bucket by bucket, skipping subtrees as soon
+ * as their bloom filters prove them disjoint. No memory is allocated.
+ *
+ * @memberof r_set
+ *
+ * @note Checks metainformation of the set objects first (comparator function,
+ * hashing function). If they are not equal, the function returns zero (0).
+ *
+ * @return the number of elements which are in both `set_a` and `set_b`
+ */
+size_t
+r_set_intersection_cardinality(
+    struct r_set const* set_a, //!< first argument of the binary operation
+    struct r_set const* set_b //!< second argument of the binary operation
+)
+__r_nonnull__(1, 2)
+;
+
+/**
+ * Get the cardinality of the symmetric difference of two sets
+ *
+ * See r_set_union_cardinality(). No memory is allocated.
+ *
+ * @memberof r_set
+ *
+ * @note Checks metainformation of the set objects first (comparator function,
+ * hashing function). If they are not equal, the sets are considered to have no
+ * common elements.
+ *
+ * @return the number of elements which are in exactly one of the sets
+ */
+size_t
+r_set_xor_cardinality(
+    struct r_set const* set_a, //!< first argument of the binary operation
+    struct r_set const* set_b //!< second argument of the binary operation
+)
+__r_nonnull__(1, 2)
+;
+
+/**
+ * Get the cardinality of the difference of two sets
+ *
+ * See r_set_union_cardinality(). No memory is allocated.
+ *
+ * @memberof r_set
+ *
+ * @note Checks metainformation of the set objects first (comparator function,
+ * hashing function). If they are not equal, the sets are considered to have no
+ * common elements.
+ *
+ * @return the number of elements of `set_a` which are not in `set_b`
+ */
+size_t
+r_set_exclude_cardinality(
+    struct r_set const* set_a, //!< first argument of the binary operation
+    struct r_set const* set_b //!< second argument of the binary operation
+)
+__r_nonnull__(1, 2)
+;
+
 /**
  * Check if one set is a subset of another
  *
+ * The check fails immediately if `set_a` has more elements than `set_b`.
+ * Otherwise, the buckets are compared pairwise, rejecting subtrees whose bloom
+ * filters are not covered by the filters of `set_b`.
+ *
  * @memberof r_set
  *
+ * @note Checks metainformation of the set objects first (comparator function,
+ * hashing function). If they are not equal, the function returns false (zero).
+ *
  * @return 1 if the first set is a subset of the second one, else zero (0)
  */
 int
@@ -231,6 +640,29 @@ r_set_is_subset(
 __r_nonnull__(1, 2)
 ;
 
+/**
+ * Check if two sets have no elements in common
+ *
+ * The buckets are compared pairwise. Subtrees are skipped as soon as their
+ * bloom filters prove them disjoint, and the check stops at the first common
+ * element. No memory is allocated.
+ *
+ * @memberof r_set
+ *
+ * @note Checks metainformation of the set objects first (comparator function,
+ * hashing function). If they are not equal, the sets are considered disjoint,
+ * and the function returns 1.
+ *
+ * @return 1 if the sets are disjoint, else zero (0)
+ */
+int
+r_set_disjoint(
+    struct r_set const* set_a, //!< first argument of the binary operation
+    struct r_set const* set_b //!< second argument of the binary operation
+)
+__r_nonnull__(1, 2)
+;
+
 /**
  * Check if two sets are equal
  *
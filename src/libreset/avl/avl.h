@@ -27,12 +27,37 @@
 #include "libreset/attributes.h"
 #include "libreset/hash.h"
 #include "libreset/set.h"
+#include "pool.h"
+
+#ifdef INDEX_LINKS
+/**
+ * Link to a node of an avl
+ *
+ * The nodes are referred to by their reference in the pool they were allocated
+ * from, which is half the size of a pointer. 0 denotes the absence of a node.
+ */
+typedef pool_ref avl_link;
+#else
+/**
+ * Link to a node of an avl
+ *
+ * The nodes are referred to by their address. NULL denotes the absence of a
+ * node.
+ */
+typedef struct avl_el* avl_link;
+#endif
+
+/**
+ * Link denoting the absence of a node
+ */
+#define AVL_NO_LINK ((avl_link) 0)
 
 /**
  * AVL Tree type
  */
 struct avl {
-    struct avl_el* root;
+    avl_link root; //!< The root node of the tree
+    size_t card; //!< The number of elements stored in the tree
 };
 
 /**
@@ -40,15 +65,49 @@ struct avl {
  *
  * This data type defines an AVL element. All operations for the AVL tree
  * implementation operate on this data type. There is no special root node type.
+ *
+ * The members are ordered by how often they are accessed: a lookup only reads
+ * the hash and the links of the nodes it passes, set operations also consult
+ * the filter. These are placed at the start of the node, in its first 32 bytes.
+ * The elements are only touched once the node in question is found.
+ *
+ * The height of the subtree is kept in the spare bits of the filter. On 64-bit
+ * targets, a node takes 48 bytes, or 32 bytes with `INDEX_LINKS`.
  */
 struct avl_el {
+    r_hash hash;            //!< The hash of the elements stored in the node
+    avl_link l;             //!< Next left node
+    avl_link r;             //!< Next right node
+    bloom filter;           //!< Bloom filter of the subtree, and its height
     struct ll ll;           //!< The linked list containing stored elements
-    r_hash hash;
-    bloom filter;           //!< Bloom filter associated with the subtree
-    unsigned int height;    //!< The height of the subtree
-    unsigned int node_cnt;  //!< The number of nodes which are in the subtree
-    struct  avl_el* l;      //!< Next left node
-    struct  avl_el* r;      //!< Next right node
+};
+
+/**
+ * Function type for processing elements of an avl
+ *
+ * Functions of this type are fed the elements of a tree along with their
+ * hashes, in ascending order of the hashes.
+ *
+ * @return 0 to continue, a negative error number to abort, or a positive
+ *         value to stop the iteration without an error
+ */
+typedef int (*avl_emitf)(void* etc, r_hash hash, void* data);
+
+/**
+ * Builder for inserting elements into an avl in bulk
+ *
+ * While elements are added, the nodes of the avl are kept in a list sorted by
+ * hash, the vine. Elements passed in ascending order of their hashes are
+ * inserted without any search, and the tree is rebalanced only once, when the
+ * building is finished.
+ */
+struct avl_builder {
+    struct avl* avl; //!< The avl being built
+    avl_link vine; //!< The nodes of the avl, sorted by hash
+    struct avl_el* prev; //!< The node preceding the last position used
+    size_t node_cnt; //!< The number of nodes in the vine
+    struct pool* pool; //!< The pool to allocate nodes from
+    struct r_set_cfg const* cfg; //!< type information provided by the user
 };
 
 /**
@@ -62,9 +121,10 @@ struct avl_el {
 int
 avl_destroy(
     struct avl* avl, //!< The avl tree
+    struct pool* pool, //!< The pool the nodes were allocated from
     struct r_set_cfg const* cfg //!< type information proveded by the user
 )
-__r_nonnull__(1, 2)
+__r_nonnull__(1, 2, 3)
 ;
 
 /**
@@ -81,9 +141,10 @@ avl_insert(
     struct avl* avl, //!< The avl tree where to insert
     r_hash hash, //!< hash value associated with d
     void* const d, //!< The data element
+    struct pool* pool, //!< The pool to allocate nodes from
     struct r_set_cfg const* cfg //!< type information provided by the user
 )
-__r_nonnull__(1, 3, 4)
+__r_nonnull__(1, 3, 4, 5)
 ;
 
 /**
@@ -102,9 +163,10 @@ avl_del(
     struct avl* avl, //!< The avl where to search in
     r_hash hash, //!< hash value
     void const* cmp, //!< element to compare against
+    struct pool* pool, //!< The pool the nodes were allocated from
     struct r_set_cfg const* cfg //!< type information provided by the user
 )
-__r_nonnull__(1, 3, 4)
+__r_nonnull__(1, 3, 4, 5)
 ;
 
 /**
@@ -122,9 +184,37 @@ avl_ndel(
     struct avl* el, //!< The avl where to search in
     r_predf pred, //!< A predicate selecting what to remove
     void* etc, //!< User-data to pass to the predicate
+    struct pool* pool, //!< The pool the nodes were allocated from
     struct r_set_cfg const* cfg //!< type information provided by the user
 )
-__r_nonnull__(1, 3, 4)
+__r_nonnull__(1, 3, 4, 5)
+;
+
+/**
+ * Delete elements within a range of hashes by their presence in another avl
+ *
+ * If `common` is non-zero, the elements of `avl` which are also in `other` are
+ * removed, else the ones which are not in `other`. Only the elements with
+ * hashes in the range [`from`, `to`] are taken into account. Subtrees of `avl`
+ * are left alone or removed without any lookup as soon as their bloom filters
+ * prove them disjoint from `other`.
+ *
+ * @memberof avl
+ *
+ * @return the number of removed elements
+ */
+unsigned int
+avl_range_ndel_other(
+    struct avl* avl, //!< The avl to delete from
+    struct avl const* other, //!< The avl to look the elements up in
+    r_hash from, //!< The lowest hash to take into account
+    r_hash to, //!< The highest hash to take into account
+    int common, //!< Whether to delete the common elements or the others
+    struct pool* pool, //!< The pool the nodes were allocated from
+    struct pool const* other_pool, //!< The pool of the nodes of `other`
+    struct r_set_cfg const* cfg //!< type information provided by the user
+)
+__r_nonnull__(1, 2, 6, 7, 8)
 ;
 
 /**
@@ -139,9 +229,10 @@ avl_find(
     struct avl const* avl, //!< The avl where to search in
     r_hash hash, //!< The hash value associated with d
     void const* const d, //!< The data element to compare to
+    struct pool const* pool, //!< The pool the nodes were allocated from
     struct r_set_cfg const* cfg //!< type information proveded by the user
 )
-__r_nonnull__(1, 3, 4)
+__r_nonnull__(1, 3, 4, 5)
 __r_warn_unused_result__
 ;
 
@@ -150,6 +241,8 @@ __r_warn_unused_result__
  *
  * A cardinality of an object in mathematics is, simply put, the count of
  * objects in it. It is usually denoted |Object|.
+ * The cardinality is maintained by all operations modifying the tree, hence
+ * this operation runs in constant time.
  * @memberof avl
  *
  * @return The cardinality
@@ -172,12 +265,297 @@ __r_warn_unused_result__
 int
 avl_select(
     struct avl const* src, //!< The source from where to select
+    struct pool const* pool, //!< The pool the nodes were allocated from
     r_predf pred, //!< The predicate
     void* pred_etc, //!< Additional information for the predicate function
     r_procf procf, //!< function processing the selected values
     void* dest //!< some pointer to pass to the procf
 )
-__r_nonnull__(1, 4)
+__r_nonnull__(1, 2, 5)
+;
+
+/**
+ * Start building an avl
+ *
+ * The avl may already contain elements. It must not be accessed until
+ * avl_build_end() was called.
+ *
+ * @memberof avl_builder
+ */
+void
+avl_build_begin(
+    struct avl_builder* builder, //!< The builder to initialize
+    struct avl* avl, //!< The avl to add elements to
+    struct pool* pool, //!< The pool to allocate nodes from
+    struct r_set_cfg const* cfg //!< type information provided by the user
+)
+__r_nonnull__(1, 2, 3, 4)
+;
+
+/**
+ * Add an element to an avl being built
+ *
+ * This function is an avl_emitf, taking the builder as `etc`. Elements which
+ * are already in the avl are ignored. Adding elements in ascending order of
+ * their hashes is linear in the number of nodes in the avl. Whenever an element
+ * has a hash not greater than the previous one, the search for the position of
+ * the node restarts at the lowest node, hence elements may be added in several
+ * ascending runs.
+ *
+ * @memberof avl_builder
+ *
+ * @return 0 on success, else negative error number (errno.h)
+ *         -ENOMEM - on allocation failed
+ */
+int
+avl_build_add(
+    void* builder, //!< The builder
+    r_hash hash, //!< The hash of the element
+    void* data //!< The element to add
+)
+__r_nonnull__(1)
+;
+
+/**
+ * Finish building an avl
+ *
+ * The nodes are arranged as a balanced tree.
+ *
+ * @memberof avl_builder
+ */
+void
+avl_build_end(
+    struct avl_builder* builder //!< The builder
+)
+__r_nonnull__(1)
+;
+
+/**
+ * Feed the elements within a range of hashes to a function
+ *
+ * The elements are processed in ascending order of their hashes.
+ *
+ * @memberof avl
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+int
+avl_range_foreach(
+    struct avl const* avl, //!< The avl to iterate over
+    r_hash from, //!< The lowest hash to take into account
+    r_hash to, //!< The highest hash to take into account
+    struct pool const* pool, //!< The pool the nodes were allocated from
+    avl_emitf emitf, //!< The function to feed the elements to
+    void* etc //!< Passed to `emitf`
+)
+__r_nonnull__(1, 4, 5)
+;
+
+/**
+ * Feed the common elements of two avls within a range of hashes to a function
+ *
+ * The elements of `avl_a` which are also in `avl_b` are processed in ascending
+ * order of their hashes. Subtrees are skipped as soon as their bloom filters
+ * prove them disjoint.
+ *
+ * @memberof avl
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+int
+avl_range_intersection(
+    struct avl const* avl_a, //!< The first operand
+    struct avl const* avl_b, //!< The second operand
+    r_hash from, //!< The lowest hash to take into account
+    r_hash to, //!< The highest hash to take into account
+    struct pool const* pool_a, //!< The pool of the nodes of `avl_a`
+    struct pool const* pool_b, //!< The pool of the nodes of `avl_b`
+    struct r_set_cfg const* cfg, //!< type information provided by the user
+    avl_emitf emitf, //!< The function to feed the elements to
+    void* etc //!< Passed to `emitf`
+)
+__r_nonnull__(1, 2, 5, 6, 7, 8)
+;
+
+/**
+ * Feed the elements common to several avls within a range to a function
+ *
+ * The elements of the first avl which are also in all the others are
+ * processed in ascending order of their hashes. Subtrees are skipped as soon
+ * as the intersection of their bloom filters and the ones of the other avls
+ * proves that there are no common elements. The first avl should be the one
+ * with the fewest elements.
+ *
+ * @memberof avl
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+int
+avl_range_intersection_n(
+    struct avl const* const* avls, //!< The operands, at least one
+    struct pool const* const* pools, //!< The pools of the operands' nodes
+    size_t n, //!< The number of operands
+    r_hash from, //!< The lowest hash to take into account
+    r_hash to, //!< The highest hash to take into account
+    struct r_set_cfg const* cfg, //!< type information provided by the user
+    avl_emitf emitf, //!< The function to feed the elements to
+    void* etc //!< Passed to `emitf`
+)
+__r_nonnull__(1, 2, 6, 7)
+;
+
+/**
+ * Feed the elements of an avl which are not in another one to a function
+ *
+ * The elements of `avl_a` within a range of hashes which are not in `avl_b`
+ * are processed in ascending order of their hashes. Subtrees of `avl_a` are
+ * processed as a whole, without any lookup, as soon as their bloom filters
+ * prove them disjoint from `avl_b`.
+ *
+ * @memberof avl
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+int
+avl_range_exclude(
+    struct avl const* avl_a, //!< The avl to take the elements from
+    struct avl const* avl_b, //!< The avl holding the elements to exclude
+    r_hash from, //!< The lowest hash to take into account
+    r_hash to, //!< The highest hash to take into account
+    struct pool const* pool_a, //!< The pool of the nodes of `avl_a`
+    struct pool const* pool_b, //!< The pool of the nodes of `avl_b`
+    struct r_set_cfg const* cfg, //!< type information provided by the user
+    avl_emitf emitf, //!< The function to feed the elements to
+    void* etc //!< Passed to `emitf`
+)
+__r_nonnull__(1, 2, 5, 6, 7, 8)
+;
+
+/**
+ * Split an avl tree at a given hash
+ *
+ * All nodes with a hash greater than or equal to `pivot` are moved from `avl`
+ * into `upper`, which is expected to be empty. The nodes are relinked rather
+ * than copied, hence no hashes have to be recomputed.
+ *
+ * @memberof avl
+ */
+void
+avl_split(
+    struct avl* avl, //!< The avl to split, keeping the lower part
+    struct avl* upper, //!< The (empty) avl receiving the upper part
+    r_hash pivot, //!< The lowest hash to move into `upper`
+    struct pool const* pool //!< The pool the nodes were allocated from
+)
+__r_nonnull__(1, 2, 4)
+;
+
+/**
+ * Join two avl trees
+ *
+ * All nodes are moved from `upper` into `avl`. All the hashes in `upper` have
+ * to be greater than the hashes in `avl`. The nodes are relinked rather than
+ * copied, hence no hashes have to be recomputed.
+ *
+ * @memberof avl
+ */
+void
+avl_join(
+    struct avl* avl, //!< The avl to join into, holding the lower hashes
+    struct avl* upper, //!< The avl holding the greater hashes
+    struct pool const* pool //!< The pool the nodes were allocated from
+)
+__r_nonnull__(1, 2, 3)
+;
+
+/**
+ * Insert an element into an avl without rebalancing it
+ *
+ * The new node is linked in as a leaf. Only the bloom filters of the nodes on
+ * the way down are updated, the heights are left as they are. The avl may thus
+ * violate the AVL property until avl_rebalance() is called, but lookups and
+ * iterations remain correct. If the node ends up too deep, the avl is
+ * rebalanced right away.
+ *
+ * @memberof avl
+ *
+ * @return 0 on success, else negative error number (errno.h)
+ *         -ENOMEM - on allocation failed
+ *         -EEXIST - if the element is already in the avl
+ */
+int
+avl_insert_deferred(
+    struct avl* avl, //!< The avl tree where to insert
+    r_hash hash, //!< hash value associated with d
+    void* const d, //!< The data element
+    struct pool* pool, //!< The pool to allocate nodes from
+    struct r_set_cfg const* cfg //!< type information proveded by the user
+)
+__r_nonnull__(1, 4, 5)
+;
+
+/**
+ * Delete an element from an avl without rebalancing it
+ *
+ * An emptied node is replaced by the lowest node of its right subtree, if
+ * there is one, and the metadata is left as it is. The bloom filters thus
+ * remain supersets of the hashes in their subtrees. Call avl_rebalance()
+ * afterwards.
+ *
+ * @memberof avl
+ *
+ * @return 0 on success, else negative error number (errno.h)
+ *         -EEXIST - if the element is not in the avl
+ */
+int
+avl_del_deferred(
+    struct avl* avl, //!< The avl tree
+    r_hash hash, //!< hash value associated with `cmp`
+    void const* cmp, //!< element to compare against
+    struct pool* pool, //!< The pool the nodes were allocated from
+    struct r_set_cfg const* cfg //!< type information provided by the user
+)
+__r_nonnull__(1, 3, 4, 5)
+;
+
+/**
+ * Rebalance an avl as a whole
+ *
+ * The avl is rebuilt as a perfectly balanced tree in linear time, and the
+ * metadata of all nodes is regenerated.
+ *
+ * @memberof avl
+ */
+void
+avl_rebalance(
+    struct avl* avl, //!< The avl to rebalance
+    struct pool const* pool //!< The pool the nodes were allocated from
+)
+__r_nonnull__(1, 2)
+;
+
+/**
+ * Copy an avl to another pool
+ *
+ * The nodes are copied in ascending order of their hashes, each followed by
+ * the further elements of its list, so they are laid out in that order in
+ * `copy_pool`. The copy is balanced perfectly. The elements themselves are not
+ * copied, both avls refer to the same ones.
+ *
+ * @memberof avl
+ *
+ * @return 0 on success, else negative error number (errno.h)
+ *         -ENOMEM - on allocation failed, the nodes of the copy allocated so
+ *                   far are left in `copy_pool`
+ */
+int
+avl_copy(
+    struct avl* copy, //!< The avl to copy to, which is overwritten
+    struct avl const* avl, //!< The avl to copy
+    struct pool const* pool, //!< The pool holding the nodes of `avl`
+    struct pool* copy_pool //!< The pool to allocate the nodes of `copy` from
+)
+__r_nonnull__(1, 2, 3, 4)
 ;
 
 /**
@@ -206,9 +584,35 @@ int
 avl_is_subset(
     struct avl const* avl_a, //!< The first avl object for the comparison
     struct avl const* avl_b,//!< The second avl object for the comparison
+    struct pool const* pool_a, //!< The pool of the nodes of `avl_a`
+    struct pool const* pool_b, //!< The pool of the nodes of `avl_b`
     struct r_set_cfg const* cfg //!< The set configuration
 )
-__r_nonnull__(1, 2, 3)
+__r_nonnull__(1, 2, 3, 4, 5)
+;
+
+/**
+ * Check if the elements of avl_a within a range of hashes are in avl_b
+ *
+ * Only the elements of `avl_a` with hashes in the range [`from`, `to`] are
+ * taken into account. This allows checking buckets which cover different
+ * ranges of hashes.
+ *
+ * @memberof avl
+ *
+ * @return 1 if the elements in the range are a subset of avl_b, else 0
+ */
+int
+avl_range_is_subset(
+    struct avl const* avl_a, //!< The first avl object for the comparison
+    struct avl const* avl_b,//!< The second avl object for the comparison
+    r_hash from, //!< The lowest hash to take into account
+    r_hash to, //!< The highest hash to take into account
+    struct pool const* pool_a, //!< The pool of the nodes of `avl_a`
+    struct pool const* pool_b, //!< The pool of the nodes of `avl_b`
+    struct r_set_cfg const* cfg //!< The set configuration
+)
+__r_nonnull__(1, 2, 5, 6, 7)
 ;
 
 /**
@@ -227,16 +631,84 @@ __r_warn_unused_result__
 
 
 /**
- * Get the number of nodes a subtree contains
+ * Count the nodes a subtree contains
+ *
+ * The nodes are not counted by the tree, hence this function visits all of
+ * them.
  *
  * @memberof avl_el
  *
  * @return The number of nodes the subtree contains
  */
-inline static unsigned int
+size_t
 avl_node_cnt(
-    struct avl_el const* root //!< The root element
+    struct avl_el const* root, //!< The root element
+    struct pool const* pool //!< The pool the nodes were allocated from
+)
+__r_nonnull__(2)
+__r_warn_unused_result__
+;
+
+/**
+ * Get the node a link refers to
+ *
+ * @memberof avl_el
+ *
+ * @return The node, or NULL if the link doesn't refer to any
+ */
+static inline struct avl_el*
+avl_node(
+    avl_link link, //!< The link to follow
+    struct pool const* pool //!< The pool the nodes were allocated from
+)
+__r_warn_unused_result__
+;
+
+/**
+ * Get the left child of a node
+ *
+ * @memberof avl_el
+ *
+ * @return The left child, or NULL
+ */
+static inline struct avl_el*
+avl_left(
+    struct avl_el const* node, //!< The node to get the child of
+    struct pool const* pool //!< The pool the nodes were allocated from
+)
+__r_nonnull__(1)
+__r_warn_unused_result__
+;
+
+/**
+ * Get the right child of a node
+ *
+ * @memberof avl_el
+ *
+ * @return The right child, or NULL
+ */
+static inline struct avl_el*
+avl_right(
+    struct avl_el const* node, //!< The node to get the child of
+    struct pool const* pool //!< The pool the nodes were allocated from
+)
+__r_nonnull__(1)
+__r_warn_unused_result__
+;
+
+/**
+ * Get the root node of an avl
+ *
+ * @memberof avl
+ *
+ * @return The root node, or NULL if the avl is empty
+ */
+static inline struct avl_el*
+avl_root(
+    struct avl const* avl, //!< The avl to get the root of
+    struct pool const* pool //!< The pool the nodes were allocated from
 )
+__r_nonnull__(1)
 __r_warn_unused_result__
 ;
 
@@ -261,17 +733,43 @@ avl_height(
     if (root == NULL) {
         return 0;
     }
-    return root->height;
+    return root->filter >> BLOOM_BITS;
 }
 
-inline static unsigned int
-avl_node_cnt(
-    struct avl_el const* root //!< The root element
+static inline struct avl_el*
+avl_node(
+    avl_link link,
+    struct pool const* pool
 ) {
-    if (!root) {
-        return 0;
-    }
-    return root->node_cnt;
+#ifdef INDEX_LINKS
+    return link ? (struct avl_el*) pool_deref(pool, link) : NULL;
+#else
+    return link;
+#endif
+}
+
+static inline struct avl_el*
+avl_left(
+    struct avl_el const* node,
+    struct pool const* pool
+) {
+    return avl_node(node->l, pool);
+}
+
+static inline struct avl_el*
+avl_right(
+    struct avl_el const* node,
+    struct pool const* pool
+) {
+    return avl_node(node->r, pool);
+}
+
+static inline struct avl_el*
+avl_root(
+    struct avl const* avl,
+    struct pool const* pool
+) {
+    return avl_node(avl->root, pool);
 }
 
 /** @} */
@@ -0,0 +1,84 @@
+#include <errno.h>
+#include <stdlib.h>
+
+#include "util/debug.h"
+
+#include "avl/avl.h"
+#include "avl/common.h"
+
+void
+avl_build_begin(
+    struct avl_builder* builder,
+    struct avl* avl,
+    struct pool* pool,
+    struct r_set_cfg const* cfg
+) {
+    avl_dbg("Start building %p", (void*) avl);
+
+    builder->avl = avl;
+    builder->vine = flatten_subtree(avl->root, &builder->node_cnt, pool);
+    builder->prev = NULL;
+    builder->pool = pool;
+    builder->cfg = cfg;
+    avl->root = AVL_NO_LINK;
+}
+
+int
+avl_build_add(
+    void* etc,
+    r_hash hash,
+    void* data
+) {
+    struct avl_builder* builder = (struct avl_builder*) etc;
+
+    // restart from the beginning if the elements are not passed in order
+    if (builder->prev && builder->prev->hash >= hash) {
+        builder->prev = NULL;
+    }
+
+    avl_link* pos = builder->prev ? &builder->prev->r : &builder->vine;
+    struct avl_el* node = avl_node(*pos, builder->pool);
+    while (node && node->hash < hash) {
+        builder->prev = node;
+        pos = &node->r;
+        node = avl_node(*pos, builder->pool);
+    }
+
+    int is_new = !node || (node->hash != hash);
+    if (is_new) {
+        avl_link next = *pos;
+        node = new_avl_el(hash, pos, builder->pool);
+        if (!node) {
+            *pos = next;
+            return -ENOMEM;
+        }
+        node->r = next;
+        ++builder->node_cnt;
+    }
+
+    int retval = ll_insert(&node->ll, data, builder->pool, builder->cfg);
+    if (retval == 0) {
+        ++builder->avl->card;
+    } else if (retval == -EEXIST) {
+        // the element is already in the avl, which is fine
+        retval = 0;
+    } else if (is_new) {
+        avl_link link = *pos;
+        *pos = node->r;
+        --builder->node_cnt;
+        free_avl_el(link, builder->pool);
+    }
+
+    return retval;
+}
+
+void
+avl_build_end(
+    struct avl_builder* builder
+) {
+    avl_dbg("Finish building %p", (void*) builder->avl);
+
+    builder->avl->root = build_subtree(&builder->vine, builder->node_cnt,
+                                       builder->pool);
+    builder->prev = NULL;
+}
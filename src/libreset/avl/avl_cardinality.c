@@ -1,18 +1,5 @@
 #include "avl/avl.h"
 
-static size_t
-subtree_cardinality(
-    struct avl_el const* subtree
-) {
-    if(!subtree) {
-        return 0;
-    }
-
-    return subtree_cardinality(subtree->l) +
-            subtree_cardinality(subtree->r) +
-            ll_count(&subtree->ll);
-}
-
 size_t
 avl_cardinality(
     struct avl const* avl
@@ -21,5 +8,5 @@ avl_cardinality(
         return 0;
     }
 
-    return subtree_cardinality(avl->root);
+    return avl->card;
 }
@@ -0,0 +1,44 @@
+#include <errno.h>
+
+#include "avl/avl.h"
+#include "avl/common.h"
+
+int
+avl_copy(
+    struct avl* copy,
+    struct avl const* avl,
+    struct pool const* pool,
+    struct pool* copy_pool
+) {
+    avl_dbg("Copying %p to %p", (void*) avl, (void*) copy);
+    struct avl_el const* stack[AVL_MAX_HEIGHT];
+    size_t depth = 0;
+    struct avl_el const* node = avl_root(avl, pool);
+
+    avl_link vine = AVL_NO_LINK;
+    avl_link* tail = &vine;
+    size_t cnt = 0;
+
+    // copy the nodes in ascending order of their hashes, into a vine
+    while (node || depth) {
+        if (node) {
+            stack[depth++] = node;
+            node = avl_left(node, pool);
+            continue;
+        }
+
+        node = stack[--depth];
+        struct avl_el* el = new_avl_el(node->hash, tail, copy_pool);
+        if (!el || ll_copy(&el->ll, &node->ll, pool, copy_pool) < 0) {
+            return -ENOMEM;
+        }
+
+        tail = &el->r;
+        ++cnt;
+        node = avl_right(node, pool);
+    }
+
+    copy->root = build_subtree(&vine, cnt, copy_pool);
+    copy->card = avl->card;
+    return 0;
+}
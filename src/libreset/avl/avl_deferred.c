@@ -0,0 +1,139 @@
+#include <errno.h>
+
+#include "libreset/hash.h"
+
+#include "ll/ll.h"
+#include "avl/avl.h"
+#include "avl/common.h"
+
+/**
+ * Unlink the root of a subtree without rebalancing
+ *
+ * @return the link to the new root of the subtree
+ */
+static avl_link
+unlink_root_node(
+    struct avl_el* node, //!< The root of the subtree
+    struct pool const* pool //!< The pool the nodes were allocated from
+) {
+    if (!node->l) {
+        return node->r;
+    }
+    if (!node->r) {
+        return node->l;
+    }
+
+    // cut the lowest node of the right subtree loose
+    avl_link* link = &node->r;
+    struct avl_el* lowest = avl_node(*link, pool);
+    while (lowest->l) {
+        link = &lowest->l;
+        lowest = avl_node(*link, pool);
+    }
+    avl_link retval = *link;
+    *link = lowest->r;
+
+    // it takes the node's place along with the node's metadata
+    lowest->l = node->l;
+    lowest->r = node->r;
+    lowest->filter = node->filter;
+    return retval;
+}
+
+int
+avl_insert_deferred(
+    struct avl* avl,
+    r_hash hash,
+    void* const d,
+    struct pool* pool,
+    struct r_set_cfg const* cfg
+) {
+    avl_dbg("Adding element %p with hash 0x%zx, deferred", d, hash);
+    bloom filter = bloom_from_hash(hash);
+    avl_link* root = &avl->root;
+    size_t depth = 0;
+
+    // the subtrees we descend into will hold the hash
+    struct avl_el* iter = avl_node(*root, pool);
+    while (iter && iter->hash != hash) {
+        iter->filter |= filter;
+        root = (hash < iter->hash) ? &iter->l : &iter->r;
+        iter = avl_node(*root, pool);
+        ++depth;
+    }
+
+    int retval;
+    if (iter) {
+        retval = ll_insert(&iter->ll, d, pool, cfg);
+    } else {
+        avl_link link;
+        struct avl_el* node = new_avl_el(hash, &link, pool);
+        if (!node) {
+            return -ENOMEM;
+        }
+        retval = ll_insert(&node->ll, d, pool, cfg);
+        if (retval) {
+            // the node would stay empty. The filters along the path may now
+            // hold the hash needlessly, which is harmless.
+            free_avl_el(link, pool);
+            return retval;
+        }
+        regen_metadata(node, pool);
+        *root = link;
+
+        if (depth >= AVL_DEFERRED_MAX_DEPTH) {
+            avl_rebalance(avl, pool);
+        }
+    }
+
+    if (retval == 0) {
+        ++avl->card;
+    }
+    return retval;
+}
+
+int
+avl_del_deferred(
+    struct avl* avl,
+    r_hash hash,
+    void const* cmp,
+    struct pool* pool,
+    struct r_set_cfg const* cfg
+) {
+    avl_dbg("Deleting element with hash 0x%zx, deferred", hash);
+    avl_link* root = &avl->root;
+
+    struct avl_el* iter = avl_node(*root, pool);
+    while (iter && iter->hash != hash) {
+        root = (hash < iter->hash) ? &iter->l : &iter->r;
+        iter = avl_node(*root, pool);
+    }
+
+    if (!iter) {
+        return -EEXIST;
+    }
+
+    int retval = ll_delete(&iter->ll, cmp, pool, cfg);
+    if (ll_is_empty(&iter->ll)) {
+        avl_dbg("Remove node from tree: %p", (void*) iter);
+        avl_link link = *root;
+        *root = unlink_root_node(iter, pool);
+        free_avl_el(link, pool);
+    }
+
+    if (retval == 0) {
+        --avl->card;
+    }
+    return retval;
+}
+
+void
+avl_rebalance(
+    struct avl* avl,
+    struct pool const* pool
+) {
+    avl_dbg("Rebalancing %p", (void*) avl);
+    size_t cnt;
+    avl_link vine = flatten_subtree(avl->root, &cnt, pool);
+    avl->root = build_subtree(&vine, cnt, pool);
+}
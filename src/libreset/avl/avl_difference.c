@@ -0,0 +1,85 @@
+#include "avl/avl.h"
+#include "avl/common.h"
+#include "bloom.h"
+
+/**
+ * Feed the elements of a subtree which are not in another one to a function
+ *
+ * Subtrees of `node_a` are fed to `emitf` as a whole as soon as their bloom
+ * filters prove them disjoint from `node_b`.
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+static int
+exclude_subtrees(
+    struct avl_el const* node_a,
+    struct avl_el const* node_b,
+    r_hash from,
+    r_hash to,
+    struct pool const* pool_a,
+    struct pool const* pool_b,
+    struct r_set_cfg const* cfg,
+    avl_emitf emitf,
+    void* etc
+) {
+    node_a = cover_range(node_a, from, to, pool_a);
+    if (!node_a) {
+        return 0;
+    }
+
+    node_b = cover_range(node_b, from, to, pool_b);
+    if (!node_b || !bloom_may_have_common(node_a->filter, node_b->filter)) {
+        return foreach_in_subtree(node_a, from, to, pool_a, emitf, etc);
+    }
+
+    int retval;
+    if (node_a->hash != from) {
+        retval = exclude_subtrees(avl_left(node_a, pool_a), node_b, from,
+                                  node_a->hash - 1, pool_a, pool_b, cfg, emitf,
+                                  etc);
+        if (retval) {
+            return retval;
+        }
+    }
+
+    // look for the node with the same hash
+    struct avl_el const* match = node_b;
+    while (match && match->hash != node_a->hash) {
+        match = (node_a->hash < match->hash) ? avl_left(match, pool_b)
+                                             : avl_right(match, pool_b);
+    }
+
+    ll_foreach(it, &node_a->ll, pool_a) {
+        if (match && ll_find(&match->ll, it->data, pool_b, cfg)) {
+            continue;
+        }
+
+        retval = emitf(etc, node_a->hash, it->data);
+        if (retval) {
+            return retval;
+        }
+    }
+
+    if (node_a->hash != to) {
+        return exclude_subtrees(avl_right(node_a, pool_a), node_b,
+                                node_a->hash + 1, to, pool_a, pool_b, cfg,
+                                emitf, etc);
+    }
+    return 0;
+}
+
+int
+avl_range_exclude(
+    struct avl const* avl_a,
+    struct avl const* avl_b,
+    r_hash from,
+    r_hash to,
+    struct pool const* pool_a,
+    struct pool const* pool_b,
+    struct r_set_cfg const* cfg,
+    avl_emitf emitf,
+    void* etc
+) {
+    return exclude_subtrees(avl_root(avl_a, pool_a), avl_root(avl_b, pool_b),
+                            from, to, pool_a, pool_b, cfg, emitf, etc);
+}
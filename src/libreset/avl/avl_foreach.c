@@ -0,0 +1,51 @@
+#include "avl/avl.h"
+#include "avl/common.h"
+
+int
+foreach_in_subtree(
+    struct avl_el const* node,
+    r_hash from,
+    r_hash to,
+    struct pool const* pool,
+    avl_emitf emitf,
+    void* etc
+) {
+    node = cover_range(node, from, to, pool);
+    if (!node) {
+        return 0;
+    }
+
+    int retval;
+    if (node->hash != from) {
+        retval = foreach_in_subtree(avl_left(node, pool), from,
+                                    node->hash - 1, pool, emitf, etc);
+        if (retval) {
+            return retval;
+        }
+    }
+
+    ll_foreach(it, &node->ll, pool) {
+        retval = emitf(etc, node->hash, it->data);
+        if (retval) {
+            return retval;
+        }
+    }
+
+    if (node->hash != to) {
+        return foreach_in_subtree(avl_right(node, pool), node->hash + 1, to,
+                                  pool, emitf, etc);
+    }
+    return 0;
+}
+
+int
+avl_range_foreach(
+    struct avl const* avl,
+    r_hash from,
+    r_hash to,
+    struct pool const* pool,
+    avl_emitf emitf,
+    void* etc
+) {
+    return foreach_in_subtree(avl_root(avl, pool), from, to, pool, emitf, etc);
+}
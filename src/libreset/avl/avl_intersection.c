@@ -0,0 +1,180 @@
+#include "avl/avl.h"
+#include "avl/common.h"
+#include "bloom.h"
+
+/**
+ * Feed the common elements of two subtrees within a range to a function
+ *
+ * Pairs of subtrees are skipped as soon as their bloom filters prove them to
+ * be disjoint.
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+static int
+intersect_subtrees(
+    struct avl_el const* node_a,
+    struct avl_el const* node_b,
+    r_hash from,
+    r_hash to,
+    struct pool const* pool_a,
+    struct pool const* pool_b,
+    struct r_set_cfg const* cfg,
+    avl_emitf emitf,
+    void* etc
+) {
+    node_a = cover_range(node_a, from, to, pool_a);
+    if (!node_a) {
+        return 0;
+    }
+
+    node_b = cover_range(node_b, from, to, pool_b);
+    if (!node_b || !bloom_may_have_common(node_a->filter, node_b->filter)) {
+        return 0;
+    }
+
+    int retval;
+    if (node_a->hash != from) {
+        retval = intersect_subtrees(avl_left(node_a, pool_a), node_b, from,
+                                    node_a->hash - 1, pool_a, pool_b, cfg,
+                                    emitf, etc);
+        if (retval) {
+            return retval;
+        }
+    }
+
+    // look for the node with the same hash
+    struct avl_el const* match = node_b;
+    while (match && match->hash != node_a->hash) {
+        match = (node_a->hash < match->hash) ? avl_left(match, pool_b)
+                                             : avl_right(match, pool_b);
+    }
+
+    if (match) {
+        ll_foreach(it, &node_a->ll, pool_a) {
+            if (!ll_find(&match->ll, it->data, pool_b, cfg)) {
+                continue;
+            }
+
+            retval = emitf(etc, node_a->hash, it->data);
+            if (retval) {
+                return retval;
+            }
+        }
+    }
+
+    if (node_a->hash != to) {
+        return intersect_subtrees(avl_right(node_a, pool_a), node_b,
+                                  node_a->hash + 1, to, pool_a, pool_b, cfg,
+                                  emitf, etc);
+    }
+    return 0;
+}
+
+int
+avl_range_intersection(
+    struct avl const* avl_a,
+    struct avl const* avl_b,
+    r_hash from,
+    r_hash to,
+    struct pool const* pool_a,
+    struct pool const* pool_b,
+    struct r_set_cfg const* cfg,
+    avl_emitf emitf,
+    void* etc
+) {
+    return intersect_subtrees(avl_root(avl_a, pool_a), avl_root(avl_b, pool_b),
+                              from, to, pool_a, pool_b, cfg, emitf, etc);
+}
+
+/**
+ * Feed the elements of a subtree within a range common to several avls
+ *
+ * The covering subtrees of all the other avls are looked up from their roots.
+ * Their bloom filters are intersected one after the other, and the subtree is
+ * skipped as soon as the intersection can't hold an element any more.
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+static int
+intersect_subtrees_n(
+    struct avl_el const* node,
+    struct pool const* pool,
+    struct avl const* const* others,
+    struct pool const* const* other_pools,
+    size_t n,
+    r_hash from,
+    r_hash to,
+    struct r_set_cfg const* cfg,
+    avl_emitf emitf,
+    void* etc
+) {
+    node = cover_range(node, from, to, pool);
+    if (!node) {
+        return 0;
+    }
+
+    bloom filter = node->filter;
+    size_t i;
+    for (i = 0; i < n; ++i) {
+        struct avl_el const* other = cover_range(avl_root(others[i],
+                                                          other_pools[i]),
+                                                 from, to, other_pools[i]);
+        if (!other || !bloom_may_have_common(filter, other->filter)) {
+            return 0;
+        }
+        filter &= other->filter;
+    }
+
+    int retval;
+    if (node->hash != from) {
+        retval = intersect_subtrees_n(avl_left(node, pool), pool, others,
+                                      other_pools, n, from, node->hash - 1,
+                                      cfg, emitf, etc);
+        if (retval) {
+            return retval;
+        }
+    }
+
+    // the node's elements are looked up in the other avls one by one
+    ll_foreach(it, &node->ll, pool) {
+        for (i = 0; i < n; ++i) {
+            struct avl_el const* match = find_node(others[i], node->hash,
+                                                   other_pools[i]);
+            if (!match ||
+                    !ll_find(&match->ll, it->data, other_pools[i], cfg)) {
+                break;
+            }
+        }
+        if (i < n) {
+            continue;
+        }
+
+        retval = emitf(etc, node->hash, it->data);
+        if (retval) {
+            return retval;
+        }
+    }
+
+    if (node->hash != to) {
+        return intersect_subtrees_n(avl_right(node, pool), pool, others,
+                                    other_pools, n, node->hash + 1, to, cfg,
+                                    emitf, etc);
+    }
+    return 0;
+}
+
+int
+avl_range_intersection_n(
+    struct avl const* const* avls,
+    struct pool const* const* pools,
+    size_t n,
+    r_hash from,
+    r_hash to,
+    struct r_set_cfg const* cfg,
+    avl_emitf emitf,
+    void* etc
+) {
+    return intersect_subtrees_n(avl_root(avls[0], pools[0]), pools[0],
+                                avls + 1, pools + 1, n - 1, from, to, cfg,
+                                emitf, etc);
+}
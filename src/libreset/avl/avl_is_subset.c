@@ -1,8 +1,42 @@
+#include <stdint.h>
+
 #include "avl.h"
+#include "avl/common.h"
+#include "bloom.h"
 
 
 /**
- * Checks if node_a is a subset of node_b
+ * Check whether the hashes of a subtree lie within a range
+ *
+ * @return 1 if all the nodes of the subtree are within the range, else 0
+ */
+static int
+subtree_within(
+    struct avl_el const* node,
+    r_hash from,
+    r_hash to,
+    struct pool const* pool
+) {
+    struct avl_el const* it;
+    for (it = node; it; it = avl_left(it, pool)) {
+        if (it->hash < from) {
+            return 0;
+        }
+    }
+    for (it = node; it; it = avl_right(it, pool)) {
+        if (it->hash > to) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Checks if the nodes of node_a within a range are a subset of node_b
+ *
+ * If the subtree `node_a` lies within the range, its bloom filter has to be
+ * covered by the one of `node_b`. Only the nodes on the boundaries of the range
+ * have to be checked for that.
  *
  * @return 1 if node_a is a subset, else 0
  */
@@ -10,32 +44,50 @@ static int
 node_is_subset(
     struct avl_el const* node_a,
     struct avl_el const* node_b,
-    struct avl_el const* node_b_root,
+    r_hash from,
+    r_hash to,
+    int within, //!< Whether the subtree `node_a` is known to be in the range
+    struct pool const* pool_a,
+    struct pool const* pool_b,
     struct r_set_cfg const* cfg
 ) {
+    node_a = cover_range(node_a, from, to, pool_a);
     if (!node_a) {
         // An empty set is always a subset of any other set
         return 1;
     }
 
+    node_b = cover_range(node_b, from, to, pool_b);
     if (!node_b) {
         // However, no empty is a superset of another (non-empty set)
         return 0;
     }
 
-    // Recursively go down the tree while taking care of the order of the hashes
-    if (node_a->hash > node_b->hash) {
-        return node_is_subset(node_a->l, node_b, node_b_root, cfg) &&
-            node_is_subset(node_a, node_b->r, node_b_root, cfg);
-    } else if (node_a->hash < node_b->hash) {
-        return node_is_subset(node_a->r, node_b, node_b_root, cfg) &&
-            node_is_subset(node_a, node_b->l, node_b_root, cfg);
+    // the elements of node_a can't be in node_b if the filter isn't covered
+    within = within || subtree_within(node_a, from, to, pool_a);
+    if (within && !bloom_may_contain(node_a->filter, node_b->filter)) {
+        return 0;
     }
 
-    // Verify that the node is in the tree by going back to the roots
-    return node_is_subset(node_a->l, node_b_root, node_b_root, cfg) &&
-            node_is_subset(node_a->r, node_b_root, node_b_root, cfg) &&
-            ll_is_subset(&node_a->ll, &node_b->ll, cfg);
+    // look for the node with the same hash
+    struct avl_el const* match = node_b;
+    while (match && match->hash != node_a->hash) {
+        match = (node_a->hash < match->hash) ? avl_left(match, pool_b)
+                                             : avl_right(match, pool_b);
+    }
+
+    if (!match ||
+            !ll_is_subset(&node_a->ll, &match->ll, pool_a, pool_b, cfg)) {
+        return 0;
+    }
+
+    // Proceed with the subtrees, narrowing the range
+    return ((node_a->hash == from) ||
+            node_is_subset(avl_left(node_a, pool_a), node_b, from,
+                           node_a->hash - 1, within, pool_a, pool_b, cfg)) &&
+        ((node_a->hash == to) ||
+            node_is_subset(avl_right(node_a, pool_a), node_b,
+                           node_a->hash + 1, to, within, pool_a, pool_b, cfg));
 }
 
 
@@ -43,12 +95,23 @@ int
 avl_is_subset(
     struct avl const* avl_a,
     struct avl const* avl_b,
+    struct pool const* pool_a,
+    struct pool const* pool_b,
     struct r_set_cfg const* cfg
 ) {
-    if (!avl_a) {
-        // An empty set is always a subset of another
-        return 1;
-    }
+    return avl_range_is_subset(avl_a, avl_b, 0, SIZE_MAX, pool_a, pool_b, cfg);
+}
 
-    return node_is_subset(avl_a->root, avl_b->root, avl_b->root, cfg);
+int
+avl_range_is_subset(
+    struct avl const* avl_a,
+    struct avl const* avl_b,
+    r_hash from,
+    r_hash to,
+    struct pool const* pool_a,
+    struct pool const* pool_b,
+    struct r_set_cfg const* cfg
+) {
+    return node_is_subset(avl_root(avl_a, pool_a), avl_root(avl_b, pool_b),
+                          from, to, 0, pool_a, pool_b, cfg);
 }
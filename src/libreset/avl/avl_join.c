@@ -0,0 +1,28 @@
+#include "util/debug.h"
+
+#include "avl/avl.h"
+#include "avl/common.h"
+
+void
+avl_join(
+    struct avl* avl,
+    struct avl* upper,
+    struct pool const* pool
+) {
+    avl_dbg("Joining %p into %p", (void*) upper, (void*) avl);
+
+    // the lowest node of the upper tree separates the two trees
+    avl_link root = isolate_leftmost(&upper->root, pool);
+    if (!root) {
+        return;
+    }
+
+    struct avl_el* node = avl_node(root, pool);
+    node->l = avl->root;
+    node->r = upper->root;
+
+    avl->root = balance_node(root, pool);
+    avl->card += upper->card;
+    upper->root = AVL_NO_LINK;
+    upper->card = 0;
+}
@@ -1,40 +1,50 @@
 #include "avl/avl.h"
+#include "avl/common.h"
 
 static int
 select_from_subtree(
     struct avl_el* root,
+    struct pool const* pool,
     r_predf pred,
     void* pred_etc,
     r_procf procf,
     void* dest
 ) {
-    if (!root) {
-        return 0;
-    }
+    struct avl_el* stack[AVL_MAX_HEIGHT];
+    size_t depth = 0;
 
-    int retval;
+    // walk down the left spine of each right subtree we encounter
+    while (root || depth) {
+        if (!root) {
+            root = avl_right(stack[--depth], pool);
+            continue;
+        }
 
-    retval = select_from_subtree(root->l, pred, pred_etc, procf, dest);
-    if (retval < 0) {
-        return retval;
-    }
+        int retval = ll_select(&root->ll, pool, pred, pred_etc, procf,
+                               dest);
+        if (retval < 0) {
+            return retval;
+        }
 
-    retval = select_from_subtree(root->r, pred, pred_etc, procf, dest);
-    if (retval < 0) {
-        return retval;
+        if (root->r) {
+            stack[depth++] = root;
+        }
+        root = avl_left(root, pool);
     }
 
-    return ll_select(&root->ll, pred, pred_etc, procf, dest);
+    return 0;
 }
 
 int
 avl_select(
     struct avl const* src,
+    struct pool const* pool,
     r_predf pred,
     void* pred_etc,
     r_procf procf,
     void* dest
 ) {
-    return select_from_subtree(src->root, pred, pred_etc, procf, dest);
+    return select_from_subtree(avl_root(src, pool), pool, pred, pred_etc,
+                               procf, dest);
 }
 
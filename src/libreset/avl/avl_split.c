@@ -0,0 +1,53 @@
+#include "util/debug.h"
+
+#include "avl/avl.h"
+#include "avl/common.h"
+
+/**
+ * Split a subtree at a given hash
+ *
+ * This function implements the isolation of subtrees as described in the
+ * paper: the nodes on the path to the pivot are cut loose from their parents
+ * and relinked into one of the two resulting subtrees. Each of these nodes
+ * joins the subtree it kept with the part split off below it, hence the
+ * results are balanced.
+ */
+static void
+split_subtree(
+    avl_link root, //!< The subtree to split
+    r_hash pivot, //!< The lowest hash to put into `upper`
+    avl_link* lower, //!< Where to put the nodes lower than `pivot`
+    avl_link* upper, //!< Where to put the remaining nodes
+    struct pool const* pool //!< The pool the nodes were allocated from
+) {
+    struct avl_el* node = avl_node(root, pool);
+    if (!node) {
+        *lower = AVL_NO_LINK;
+        *upper = AVL_NO_LINK;
+        return;
+    }
+
+    if (node->hash < pivot) {
+        split_subtree(node->r, pivot, &node->r, upper, pool);
+        *lower = balance_node(root, pool);
+    } else {
+        split_subtree(node->l, pivot, lower, &node->l, pool);
+        *upper = balance_node(root, pool);
+    }
+}
+
+void
+avl_split(
+    struct avl* avl,
+    struct avl* upper,
+    r_hash pivot,
+    struct pool const* pool
+) {
+    avl_dbg("Splitting %p at hash 0x%zx", (void*) avl, pivot);
+
+    split_subtree(avl->root, pivot, &avl->root, &upper->root, pool);
+
+    // buckets hold only few nodes, so counting one of the parts is cheap
+    upper->card = subtree_cardinality(avl_root(upper, pool), pool);
+    avl->card -= upper->card;
+}
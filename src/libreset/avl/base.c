@@ -27,12 +27,13 @@
  */
 static int
 remove_element(
-    struct avl_el** root, //!< The avl where to search in
+    avl_link* root, //!< The avl where to search in
     r_hash hash, //!< hash value associated with d
     void const* cmp, //!< element to compare against
+    struct pool* pool, //!< The pool the nodes were allocated from
     struct r_set_cfg const* cfg //!< type information provided by the user
 )
-__r_nonnull__(1, 3, 4)
+__r_nonnull__(1, 3, 4, 5)
 ;
 
 /**
@@ -44,26 +45,54 @@ static int
 insert_element_into_tree(
     void* el, //!< The element to insert
     r_hash hash, //!< hash of the element to insert
-    struct avl_el** root, //!< The root element of the tree where to insert
+    avl_link* root, //!< The root element of the tree where to insert
+    struct pool* pool, //!< The pool to allocate nodes from
     struct r_set_cfg const* cfg //!< type information proveded by the user
 )
-__r_nonnull__(1, 3, 4)
+__r_nonnull__(1, 3, 4, 5)
 ;
 
 /**
  * Delete all elements in the tree under `root` for which the predicate `pred`
  * evaluates true.
  *
+ * The remaining nodes are arranged as a balanced tree.
+ *
  * @return Number of removed elements.
  */
 static unsigned int
 delete_elements_by_predicate(
-    struct avl_el** root,
+    avl_link* root,
     r_predf pred,
     void* etc,
+    struct pool* pool,
     struct r_set_cfg const* cfg
 )
-__r_nonnull__(1, 2, 3, 4)
+__r_nonnull__(1, 2, 3, 4, 5)
+;
+
+/**
+ * Delete the elements of a subtree within a range by their presence in another
+ *
+ * If `common` is non-zero, the elements which are also in the subtree `other`
+ * are deleted, else the ones which are not. Subtrees are only descended into
+ * as far as their bloom filters do not prove them disjoint from `other`. The
+ * remaining nodes are rebalanced on the way back up.
+ *
+ * @return Number of removed elements.
+ */
+static unsigned int
+delete_elements_by_other(
+    avl_link* root, //!< The root of the subtree to delete from
+    struct avl_el const* other, //!< The subtree to look the elements up in
+    r_hash from, //!< The lowest hash to take into account
+    r_hash to, //!< The highest hash to take into account
+    int common, //!< Whether to delete the common elements or the others
+    struct pool* pool, //!< The pool the nodes were allocated from
+    struct pool const* other_pool, //!< The pool of the nodes of `other`
+    struct r_set_cfg const* cfg //!< type information provided by the user
+)
+__r_nonnull__(1, 6, 7, 8)
 ;
 
 /*
@@ -77,11 +106,13 @@ __r_nonnull__(1, 2, 3, 4)
 int
 avl_destroy(
     struct avl* avl, //!< The avl tree
+    struct pool* pool,
     struct r_set_cfg const* cfg
 ) {
     if (avl && avl->root) {
-        destroy_subtree(avl->root, cfg);
-        avl->root = NULL;
+        destroy_subtree(avl->root, pool, cfg);
+        avl->root = AVL_NO_LINK;
+        avl->card = 0;
     } else {
         return -EEXIST;
     }
@@ -93,16 +124,17 @@ avl_find(
     struct avl const* avl,
     r_hash hash,
     void const* const d,
+    struct pool const* pool,
     struct r_set_cfg const* cfg
 ) {
     avl_dbg("Finding element for hash: 0x%zx", hash);
-    struct avl_el* node = find_node(avl, hash);
+    struct avl_el* node = find_node(avl, hash, pool);
 
     if (!node) {
         return NULL;
     }
 
-    return ll_find(&node->ll, d, cfg);
+    return ll_find(&node->ll, d, pool, cfg);
 }
 
 int
@@ -110,12 +142,15 @@ avl_insert(
     struct avl* avl, //!< The avl tree where to insert
     r_hash hash,
     void* const d, //!< The data element
+    struct pool* pool,
     struct r_set_cfg const* cfg
 ) {
     avl_dbg("Adding element %p with hash: 0x%zx", d, hash);
 
-    int retval = insert_element_into_tree(d, hash, &avl->root, cfg);
-    avl->root = rebalance_subtree(avl->root);
+    int retval = insert_element_into_tree(d, hash, &avl->root, pool, cfg);
+    if (retval == 0) {
+        ++avl->card;
+    }
 
     return retval;
 }
@@ -125,11 +160,14 @@ avl_del(
     struct avl* avl,
     r_hash hash,
     void const* cmp,
+    struct pool* pool,
     struct r_set_cfg const* cfg
 ) {
     avl_dbg("Deleting element with hash: 0x%zx", hash);
-    int retval = remove_element(&avl->root, hash, cmp, cfg);
-    avl->root = rebalance_subtree(avl->root);
+    int retval = remove_element(&avl->root, hash, cmp, pool, cfg);
+    if (retval == 0) {
+        --avl->card;
+    }
     return retval;
 }
 
@@ -138,10 +176,31 @@ avl_ndel(
     struct avl* el,
     r_predf pred,
     void* etc,
+    struct pool* pool,
+    struct r_set_cfg const* cfg
+) {
+    unsigned int retval = delete_elements_by_predicate(&el->root, pred, etc,
+                                                       pool, cfg);
+    el->card -= retval;
+    return retval;
+}
+
+unsigned int
+avl_range_ndel_other(
+    struct avl* avl,
+    struct avl const* other,
+    r_hash from,
+    r_hash to,
+    int common,
+    struct pool* pool,
+    struct pool const* other_pool,
     struct r_set_cfg const* cfg
 ) {
-    unsigned int retval = delete_elements_by_predicate(&el->root, pred, etc, cfg);
-    el->root = rebalance_subtree(el->root);
+    unsigned int retval = delete_elements_by_other(&avl->root,
+                                                   avl_root(other, other_pool),
+                                                   from, to, common, pool,
+                                                   other_pool, cfg);
+    avl->card -= retval;
     return retval;
 }
 
@@ -157,124 +216,224 @@ static int
 insert_element_into_tree(
     void* d,
     r_hash hash,
-    struct avl_el** root,
+    avl_link* root,
+    struct pool* pool,
     struct r_set_cfg const* cfg
 ) {
     avl_dbg("Inserting element %p with hash: 0x%zx", d, hash);
-    int retval;
-
-    // we reached the bottom of the tree
-    if (*root == NULL) {
-        // create new node and insert
-        struct avl_el* node = new_avl_el(hash);
-        if (!node) {
-            // out of memory
-            return -ENOMEM;
-        }
-        retval = ll_insert(&node->ll, d, cfg);
+    avl_link* path[AVL_MAX_HEIGHT];
+    size_t depth = 0;
+
+    // descend, remembering the links we followed
+    struct avl_el* iter = avl_node(*root, pool);
+    while (iter && iter->hash != hash) {
+        path[depth++] = root;
+        root = (hash < iter->hash) ? &iter->l : &iter->r;
+        iter = avl_node(*root, pool);
+    }
 
-        *root = node;
-        regen_metadata(*root);
-        return retval;
+    // insert into an existing node, the tree's structure does not change
+    if (iter) {
+        return ll_insert(&iter->ll, d, pool, cfg);
     }
 
-    // recurse if neccessary
-    if (hash < (*root)->hash) {
-        retval = insert_element_into_tree(d, hash, &(*root)->l, cfg);
-        regen_metadata(*root);
-        return retval;
+    // we reached the bottom of the tree, create new node and insert
+    avl_link link;
+    struct avl_el* node = new_avl_el(hash, &link, pool);
+    if (!node) {
+        // out of memory
+        return -ENOMEM;
     }
-    if (hash > (*root)->hash) {
-        retval = insert_element_into_tree(d, hash, &(*root)->r, cfg);
-        regen_metadata(*root);
+    int retval = ll_insert(&node->ll, d, pool, cfg);
+    if (retval) {
+        // the node would stay empty
+        free_avl_el(link, pool);
         return retval;
     }
 
-    // insert into this element, not creating new nodes
-    return ll_insert(&(*root)->ll, d, cfg);
+    *root = link;
+    regen_metadata(node, pool);
+    rebalance_path(path, depth, pool);
+    return 0;
 }
 
 static int
 remove_element(
-    struct avl_el** root,
+    avl_link* root,
     r_hash hash,
     void const* cmp,
+    struct pool* pool,
     struct r_set_cfg const* cfg
 ) {
     avl_dbg("Remove element with hash: 0x%zx", hash);
+    avl_link* path[AVL_MAX_HEIGHT];
+    size_t depth = 0;
+
+    // descend, remembering the links we followed
+    struct avl_el* iter = avl_node(*root, pool);
+    while (iter && iter->hash != hash) {
+        path[depth++] = root;
+        root = (hash < iter->hash) ? &iter->l : &iter->r;
+        iter = avl_node(*root, pool);
+    }
 
     // check whether the subtree is empty
-    if (!*root) {
+    if (!iter) {
         return -EEXIST;
     }
 
-    int retval;
-
-    // iterate into subnodes if neccessary
-    if (hash < (*root)->hash) {
-        retval = remove_element(&(*root)->l, hash, cmp, cfg);
-        regen_metadata(*root);
-        return retval;
-    }
-
-    if (hash > (*root)->hash) {
-        retval = remove_element(&(*root)->r, hash, cmp, cfg);
-        regen_metadata(*root);
-        return retval;
-    }
-
     // remove element from linked list
-    retval = ll_delete(&(*root)->ll, cmp, cfg);
+    int retval = ll_delete(&iter->ll, cmp, pool, cfg);
 
     // remove the node if neccessary
-    if (ll_is_empty(&(*root)->ll)) {
-        avl_dbg("Remove node from tree: %p", (void*) *root);
+    if (ll_is_empty(&iter->ll)) {
+        avl_dbg("Remove node from tree: %p", (void*) iter);
         // isolate the node
-        struct avl_el* to_del = *root;
-        *root = isolate_root_node(to_del);
-        if (*root) {
-            regen_metadata(*root);
-        }
+        avl_link link = *root;
+        *root = isolate_root_node(iter, pool);
 
         // delete the node
-        free(to_del);
+        free_avl_el(link, pool);
+        rebalance_path(path, depth, pool);
     }
     return retval;
 }
 
 static unsigned int
 delete_elements_by_predicate(
-    struct avl_el** root,
+    avl_link* root,
     r_predf pred,
     void* etc,
+    struct pool* pool,
     struct r_set_cfg const* cfg
 ) {
-    // check whether the subtree is empty
-    if (!*root) {
+    unsigned int retval = 0;
+
+    // all nodes are visited anyway, so we walk them as a vine
+    size_t cnt;
+    avl_link vine = flatten_subtree(*root, &cnt, pool);
+    avl_link* iter = &vine;
+
+    while (*iter) {
+        struct avl_el* node = avl_node(*iter, pool);
+
+        // remove elements from this node
+        retval += ll_ndel(&node->ll, pred, etc, pool, cfg);
+
+        // remove the node if neccessary
+        if (ll_is_empty(&node->ll)) {
+            avl_dbg("Remove node from tree: %p", (void*) node);
+            avl_link link = *iter;
+            *iter = node->r;
+            free_avl_el(link, pool);
+            --cnt;
+        } else {
+            iter = &node->r;
+        }
+    }
+
+    *root = build_subtree(&vine, cnt, pool);
+    return retval;
+}
+
+/**
+ * Lookup of elements in a node, used by delete_elements_by_other()
+ */
+struct other_node {
+    struct ll const* ll; //!< The elements of the node, or NULL
+    struct pool const* pool; //!< The pool the elements were allocated from
+    int common; //!< Whether to select the common elements or the others
+    struct r_set_cfg const* cfg; //!< type information provided by the user
+};
+
+/**
+ * Select an element by its presence in a node
+ *
+ * This function is a r_predf, taking a struct other_node as `etc`.
+ *
+ * @return 1 if the element is selected, else 0
+ */
+static int
+select_by_other_node(
+    void const* data,
+    void* etc
+) {
+    struct other_node const* other = (struct other_node const*) etc;
+    int found = other->ll && ll_find(other->ll, data, other->pool, other->cfg);
+    return found == other->common;
+}
+
+static unsigned int
+delete_elements_by_other(
+    avl_link* root,
+    struct avl_el const* other,
+    r_hash from,
+    r_hash to,
+    int common,
+    struct pool* pool,
+    struct pool const* other_pool,
+    struct r_set_cfg const* cfg
+) {
+    struct avl_el* node = avl_node(*root, pool);
+    if (!node) {
         return 0;
     }
 
-    unsigned int retval = 0;
+    unsigned int retval;
 
-    // iterate into subnodes
-    retval += delete_elements_by_predicate(&(*root)->l, pred, etc, cfg);
-    retval += delete_elements_by_predicate(&(*root)->r, pred, etc, cfg);
+    // descend into the subtree covering the range
+    if (node->hash < from || node->hash > to) {
+        avl_link* child = (node->hash < from) ? &node->r : &node->l;
+        retval = delete_elements_by_other(child, other, from, to, common,
+                                          pool, other_pool, cfg);
+        *root = balance_node(*root, pool);
+        return retval;
+    }
 
-    // remove elements from this node
-    retval += ll_ndel(&(*root)->ll, pred, etc, cfg);
+    // if the subtrees are disjoint, there are no common elements to delete
+    other = cover_range(other, from, to, other_pool);
+    if (other && !bloom_may_have_common(node->filter, other->filter)) {
+        other = NULL;
+    }
+    if (!other && common) {
+        return 0;
+    }
 
-    // remove the node if neccessary
-    if (ll_is_empty(&(*root)->ll)) {
-        avl_dbg("Remove node from tree: %p", (void*) *root);
-        // isolate the node
-        struct avl_el* to_del = *root;
-        *root = isolate_root_node(to_del);
+    retval = 0;
+    if (node->hash != from) {
+        retval += delete_elements_by_other(&node->l, other, from,
+                                           node->hash - 1, common, pool,
+                                           other_pool, cfg);
+    }
+    if (node->hash != to) {
+        retval += delete_elements_by_other(&node->r, other, node->hash + 1,
+                                           to, common, pool, other_pool, cfg);
+    }
 
-        // delete the node
-        free(to_del);
+    // look for the node with the same hash
+    struct avl_el const* match = other;
+    while (match && match->hash != node->hash) {
+        match = (node->hash < match->hash) ? avl_left(match, other_pool)
+                                           : avl_right(match, other_pool);
     }
 
-    regen_metadata(*root);
+    struct other_node lookup = {
+        .ll = match ? &match->ll : NULL,
+        .pool = other_pool,
+        .common = common,
+        .cfg = cfg,
+    };
+    retval += ll_ndel(&node->ll, select_by_other_node, &lookup, pool, cfg);
+
+    // remove the node if neccessary, the subtrees may have shrunk either way
+    if (ll_is_empty(&node->ll)) {
+        avl_dbg("Remove node from tree: %p", (void*) node);
+        avl_link link = *root;
+        *root = isolate_root_node(node, pool);
+        free_avl_el(link, pool);
+    } else {
+        *root = balance_node(*root, pool);
+    }
     return retval;
 }
 
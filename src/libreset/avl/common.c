@@ -1,3 +1,4 @@
+#include <stddef.h>
 #include <stdlib.h>
 
 #include "libreset/hash.h"
@@ -11,136 +12,188 @@
 #include "avl/common.h"
 #include "util/macros.h"
 
+// a lookup must find everything it reads in the first 32 bytes of a node
+_Static_assert(offsetof(struct avl_el, filter) + sizeof(bloom) <= 32,
+               "the lookup fields of struct avl_el exceed 32 bytes");
+
+// the height of a subtree is kept in the spare bits of its filter
+_Static_assert(AVL_MAX_HEIGHT < (1 << BLOOM_SPARE_BITS),
+               "the height of an avl exceeds the spare bits of a filter");
+
+#if defined(INDEX_LINKS) && defined(__GNUC__)
+_Static_assert(sizeof(struct avl_el) <= 32, "struct avl_el exceeds 32 bytes");
+#elif !defined(INDEX_LINKS)
+_Static_assert(sizeof(struct avl_el) <= 6 * sizeof(void*),
+               "struct avl_el exceeds six words");
+#endif
+
 struct avl_el*
 new_avl_el(
-    r_hash h
+    r_hash h,
+    avl_link* link,
+    struct pool* pool
 ) {
-    struct avl_el* el = calloc(1, sizeof(*el));
+#ifdef INDEX_LINKS
+    struct avl_el* el = pool_alloc_ref(pool, sizeof(*el), link);
+#else
+    struct avl_el* el = *link = pool_alloc(pool, sizeof(*el));
+#endif
     if (el) {
         el->hash = h;
     }
     return el;
 }
 
+void
+free_avl_el(
+    avl_link link,
+    struct pool* pool
+) {
+#ifdef INDEX_LINKS
+    pool_free_ref(pool, link, sizeof(struct avl_el));
+#else
+    pool_free(pool, link, sizeof(struct avl_el));
+#endif
+}
+
 void
 destroy_subtree(
-    struct avl_el* node, //!< A node to destroy
+    avl_link root, //!< A node to destroy
+    struct pool* pool,
     struct r_set_cfg const* cfg
 ) {
-    avl_dbg("Destroying subtree from node %p", (void*) node);
+    avl_dbg("Destroying subtree from node %p", (void*) avl_node(root, pool));
 
-    if (!node) {
-        return;
-    }
-
-    if (node->l) {
-        destroy_subtree(node->l, cfg);
-    }
-    if (node->r) {
-        destroy_subtree(node->r, cfg);
+    while (root) {
+        struct avl_el* node = avl_node(root, pool);
+        avl_link l = node->l;
+        if (l) {
+            // rotate right until the lowest node is on top
+            node->l = avl_node(l, pool)->r;
+            avl_node(l, pool)->r = root;
+            root = l;
+        } else {
+            // the lowest node has no left subtree, destroy it
+            avl_link r = node->r;
+            ll_destroy(&node->ll, pool, cfg);
+            free_avl_el(root, pool);
+            root = r;
+        }
     }
-
-    ll_destroy(&node->ll, cfg);
-    free(node);
 }
 
-struct avl_el*
-rebalance_subtree(
-    struct avl_el* root
+avl_link
+balance_node(
+    avl_link root,
+    struct pool const* pool
 ) {
-    avl_dbg("Rebalance subtree for %p", (void*) root);
-    // check whether the root node is NULL
-    if (!root) {
-        return NULL;
-    }
-
-    // check whether the subtrees is already balanced (see paper)
-    if (avl_node_cnt(root) >
-            (unsigned int) (1 << (avl_height(root) - 1) ) - 1) {
-        avl_dbg("Subtree already balanced for %p", (void*) root);
-        return root;
-    }
-
-    // perform a left-rotation if there are too many nodes in the right subtree
-    while (avl_node_cnt(root->r) > (2 * avl_node_cnt(root->l) + 1)) {
-        // perform right-rotations in the right subtree if necessary
-        while (avl_node_cnt(root->r->r) <= avl_node_cnt(root->l)) {
-            root->r = rotate_right(root->r);
+    struct avl_el* node = avl_node(root, pool);
+    struct avl_el* l = avl_left(node, pool);
+    struct avl_el* r = avl_right(node, pool);
+
+    // the left subtree is too high
+    while (avl_height(l) > avl_height(r) + 1) {
+        // the inner grandchild has to be moved outwards first
+        if (avl_height(avl_left(l, pool)) < avl_height(avl_right(l, pool))) {
+            node->l = rotate_left(node->l, pool);
         }
+        root = rotate_right(root, pool);
+        node = avl_node(root, pool);
 
-        root = rotate_left(root);
+        // the old root may still be unbalanced if the difference was big
+        node->r = balance_node(node->r, pool);
+        l = avl_left(node, pool);
+        r = avl_right(node, pool);
     }
 
-    // perform a right-rotation if there are too many nodes in the right subtree
-    while (avl_node_cnt(root->l) > (2 * avl_node_cnt(root->r) + 1)) {
-        // perform left-rotations in the right subtree if necessary
-        while (avl_node_cnt(root->l->l) <= avl_node_cnt(root->r)) {
-            root->l = rotate_left(root->l);
+    // the right subtree is too high
+    while (avl_height(r) > avl_height(l) + 1) {
+        // the inner grandchild has to be moved outwards first
+        if (avl_height(avl_right(r, pool)) < avl_height(avl_left(r, pool))) {
+            node->r = rotate_right(node->r, pool);
         }
+        root = rotate_left(root, pool);
+        node = avl_node(root, pool);
 
-        root = rotate_right(root);
+        // the old root may still be unbalanced if the difference was big
+        node->l = balance_node(node->l, pool);
+        l = avl_left(node, pool);
+        r = avl_right(node, pool);
     }
 
-    // now rebalance the children
-    root->l = rebalance_subtree(root->l);
-    root->r = rebalance_subtree(root->r);
-
+    regen_metadata(node, pool);
     return root;
 }
 
-struct avl_el*
+void
+rebalance_path(
+    avl_link* const* path,
+    size_t depth,
+    struct pool const* pool
+) {
+    while (depth--) {
+        *path[depth] = balance_node(*path[depth], pool);
+    }
+}
+
+avl_link
 rotate_left(
-    struct avl_el* node
+    avl_link root,
+    struct pool const* pool
 ) {
+    struct avl_el* node = avl_node(root, pool);
     avl_dbg("Rotate left around %p", (void*) node);
-    if (!node || !node->r) {
-        return node;
+    avl_link new_root = node->r;
+    if (!new_root) {
+        return root;
     }
-
-    struct avl_el* new_root = node->r;
+    struct avl_el* new_node = avl_node(new_root, pool);
 
     // relocate the middle subtree
-    node->r = new_root->l;
+    node->r = new_node->l;
 
     // old root node is now child of new root node
-    new_root->l = node;
+    new_node->l = root;
 
     // regenerate the node's metadata
-    regen_metadata(node);
-    regen_metadata(new_root);
+    regen_metadata(node, pool);
+    regen_metadata(new_node, pool);
 
     // return new root node
     return new_root;
 }
 
-struct avl_el*
+avl_link
 rotate_right(
-    struct avl_el* node
+    avl_link root,
+    struct pool const* pool
 ) {
+    struct avl_el* node = avl_node(root, pool);
     avl_dbg("Rotate right around %p", (void*) node);
-    if (!node || !node->l) {
-        return node;
+    avl_link new_root = node->l;
+    if (!new_root) {
+        return root;
     }
-
-    struct avl_el* new_root = node->l;
+    struct avl_el* new_node = avl_node(new_root, pool);
 
     // relocate the middle subtree
-    node->l = new_root->r;
+    node->l = new_node->r;
 
     // old root node is now child of new root node
-    new_root->r = node;
+    new_node->r = root;
 
     // regenerate the node's metadata
-    regen_metadata(node);
-    regen_metadata(new_root);
+    regen_metadata(node, pool);
+    regen_metadata(new_node, pool);
 
     // return new root node
     return new_root;
 }
 
-struct avl_el*
+avl_link
 isolate_root_node(
-    struct avl_el* node
+    struct avl_el* node,
+    struct pool const* pool
 ) {
     avl_dbg("Isolate node from tree: %p", (void*) node);
 
@@ -150,77 +203,186 @@ isolate_root_node(
     }
 
     // assume that a suitable replacement exists in the right subtree
-    struct avl_el* new_root = isolate_leftmost(&node->r);
+    avl_link new_root = isolate_leftmost(&node->r, pool);
 
     // seems like a replacement does not exist. The right subtree must be empty
     if (!new_root) {
         return node->l;
     }
 
-    // insert the new node
-    new_root->l = node->l;
-    new_root->r = node->r;
-    regen_metadata(new_root);
-
-    return new_root;
+    // insert the new node, the right subtree may have shrunk
+    struct avl_el* new_node = avl_node(new_root, pool);
+    new_node->l = node->l;
+    new_node->r = node->r;
+    return balance_node(new_root, pool);
 }
 
-struct avl_el*
+avl_link
 isolate_leftmost(
-    struct avl_el** root
+    avl_link* root,
+    struct pool const* pool
 ) {
     if (!root || !*root) {
-        return NULL;
+        return AVL_NO_LINK;
     }
-    avl_dbg("Isolate leftmost node for tree %p", (void*) *root);
-
-    // recurse
-    struct avl_el* retval = isolate_leftmost(&(*root)->l);
-
-    // if the recursion solved the problem already, we can return
-    if (retval) {
-        regen_metadata(*root);
-        return retval;
+    avl_dbg("Isolate leftmost node for tree %p",
+            (void*) avl_node(*root, pool));
+    avl_link* path[AVL_MAX_HEIGHT];
+    size_t depth = 0;
+
+    // descend to the lowest element
+    struct avl_el* node = avl_node(*root, pool);
+    while (node->l) {
+        path[depth++] = root;
+        root = &node->l;
+        node = avl_node(*root, pool);
     }
 
-    // else the lowest element is the one at hand
-    retval = *root;
-
     // all that is left to do is cutting the element loose
-    *root = retval->r;
+    avl_link retval = *root;
+    *root = node->r;
+    rebalance_path(path, depth, pool);
     return retval;
 }
 
 void
 regen_metadata(
-    struct avl_el* node //!< The node to regenerate
+    struct avl_el* node, //!< The node to regenerate
+    struct pool const* pool
 ) {
     avl_dbg("Regenerate metadata for node %p", (void*) node);
+    struct avl_el const* l = avl_left(node, pool);
+    struct avl_el const* r = avl_right(node, pool);
 
-    // regenerate the height
-    node->height = 1 + MAX(avl_height(node->l), avl_height(node->r));
+    // regenerate bloom filter
+    bloom filter = bloom_from_hash(node->hash);
+    if (l) {
+        filter |= l->filter & BLOOM_MASK;
+    }
+    if (r) {
+        filter |= r->filter & BLOOM_MASK;
+    }
 
-    // regenerate the node count
-    node->node_cnt = 1 + avl_node_cnt(node->l) + avl_node_cnt(node->r);
+    // regenerate the height, which goes to the spare bits
+    bloom height = 1 + MAX(avl_height(l), avl_height(r));
+    node->filter = filter | (height << BLOOM_BITS);
+}
 
-    // regenerate bloom filter
-    node->filter = bloom_from_hash(node->hash);
-    if (node->l) {
-        node->filter |= node->l->filter;
+struct avl_el*
+cover_range(
+    struct avl_el const* node,
+    r_hash from,
+    r_hash to,
+    struct pool const* pool
+) {
+    while (node && (node->hash < from || node->hash > to)) {
+        node = (node->hash < from) ? avl_right(node, pool)
+                                   : avl_left(node, pool);
+    }
+    return (struct avl_el*) node;
+}
+
+avl_link
+flatten_subtree(
+    avl_link root,
+    size_t* cnt,
+    struct pool const* pool
+) {
+    avl_dbg("Flatten subtree %p", (void*) avl_node(root, pool));
+    avl_link vine = AVL_NO_LINK;
+    avl_link* tail = &vine;
+
+    *cnt = 0;
+    while (root) {
+        struct avl_el* node = avl_node(root, pool);
+        avl_link l = node->l;
+        if (l) {
+            // rotate right until the lowest node is on top
+            node->l = avl_node(l, pool)->r;
+            avl_node(l, pool)->r = root;
+            root = l;
+        } else {
+            // append the lowest node to the vine
+            *tail = root;
+            tail = &node->r;
+            root = node->r;
+            ++*cnt;
+        }
+    }
+
+    return vine;
+}
+
+avl_link
+build_subtree(
+    avl_link* vine,
+    size_t cnt,
+    struct pool const* pool
+) {
+    if (!cnt) {
+        return AVL_NO_LINK;
+    }
+
+    avl_link l = build_subtree(vine, cnt / 2, pool);
+
+    avl_link root = *vine;
+    struct avl_el* node = avl_node(root, pool);
+    *vine = node->r;
+
+    node->l = l;
+    node->r = build_subtree(vine, cnt - cnt / 2 - 1, pool);
+    regen_metadata(node, pool);
+
+    return root;
+}
+
+size_t
+subtree_cardinality(
+    struct avl_el const* root,
+    struct pool const* pool
+) {
+    struct avl_el const* stack[AVL_MAX_HEIGHT];
+    size_t depth = 0;
+    size_t card = 0;
+
+    // walk down the left spine of each right subtree we encounter
+    while (root || depth) {
+        if (!root) {
+            root = avl_right(stack[--depth], pool);
+            continue;
+        }
+
+        card += ll_count(&root->ll, pool);
+        if (root->r) {
+            stack[depth++] = root;
+        }
+        root = avl_left(root, pool);
     }
-    if (node->r) {
-        node->filter |= node->r->filter;
+
+    return card;
+}
+
+size_t
+avl_node_cnt(
+    struct avl_el const* root,
+    struct pool const* pool
+) {
+    if (!root) {
+        return 0;
     }
+    return 1 + avl_node_cnt(avl_left(root, pool), pool) +
+        avl_node_cnt(avl_right(root, pool), pool);
 }
 
 struct avl_el*
 find_node(
     struct avl const* avl,
-    r_hash hash
+    r_hash hash,
+    struct pool const* pool
 ) {
     avl_dbg("Finding node with hash: 0x%zx", hash);
 
-    struct avl_el* iter = avl->root;
+    struct avl_el* iter = avl_root(avl, pool);
     bloom filter = bloom_from_hash(hash);
 
     while (iter && iter->hash != hash) {
@@ -230,9 +392,9 @@ find_node(
         }
 
         if (iter->hash > hash) {
-            iter = iter->l;
+            iter = avl_left(iter, pool);
         } else {
-            iter = iter->r;
+            iter = avl_right(iter, pool);
         }
     }
 
@@ -242,7 +404,8 @@ find_node(
 struct avl_el*
 find_closest_lower(
     struct avl_el* root,
-    r_hash hash
+    r_hash hash,
+    struct pool const* pool
 ) {
     avl_dbg("Finding node closest to but lower or equal: 0x%zx", hash);
 
@@ -251,7 +414,7 @@ find_closest_lower(
         if (root->hash < hash) {
             break;
         }
-        root = root->l;
+        root = avl_left(root, pool);
     }
 
     // if we are on a node, we are on a node with a lower key/hash
@@ -263,7 +426,7 @@ find_closest_lower(
             return retval;
         }
         retval = root;
-        root = root->r;
+        root = avl_right(root, pool);
     }
 
     // we hit the bottom of the tree
@@ -273,7 +436,8 @@ find_closest_lower(
 struct avl_el*
 find_closest_greater(
     struct avl_el* root,
-    r_hash hash
+    r_hash hash,
+    struct pool const* pool
 ) {
     avl_dbg("Finding node closest to but greater or equal: 0x%zx", hash);
 
@@ -282,7 +446,7 @@ find_closest_greater(
         if (root->hash > hash) {
             break;
         }
-        root = root->r;
+        root = avl_right(root, pool);
     }
 
     // if we are on a node, we are on a node with a greater key/hash
@@ -294,10 +458,9 @@ find_closest_greater(
             return retval;
         }
         retval = root;
-        root = root->l;
+        root = avl_left(root, pool);
     }
 
     // we hit the bottom of the tree
     return retval;
 }
-
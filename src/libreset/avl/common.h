@@ -1,6 +1,25 @@
 #include "libreset/hash.h"
 
 #include "avl.h"
+#include "util/macros.h"
+
+/**
+ * Upper bound for the height of an avl
+ *
+ * An avl holds at most one node per hash. The height of an AVL tree is below
+ * 1.45 times the number of bits of its keys. This bound is used for sizing
+ * explicit stacks instead of recursing.
+ */
+#define AVL_MAX_HEIGHT (2 * BITCOUNT((r_hash) 0))
+
+/**
+ * Depth at which an avl modified without rebalancing is rebalanced anyway
+ *
+ * Insertions deferring the rebalancing may leave an avl arbitrarily deep. For
+ * the explicit stacks sized by AVL_MAX_HEIGHT to remain sufficient, an avl is
+ * rebalanced as soon as a node is inserted at this depth.
+ */
+#define AVL_DEFERRED_MAX_DEPTH (AVL_MAX_HEIGHT / 2)
 
 /**
  * Debug print helper for avl implementation code
@@ -13,63 +32,88 @@
 
 void
 destroy_subtree(
-    struct avl_el* node, //!< A node to destroy
+    avl_link root, //!< The root of the subtree to destroy
+    struct pool* pool, //!< The pool the nodes were allocated from
     struct r_set_cfg const* cfg //!< type information proveded by the user
 )
-__r_nonnull__(2)
+__r_nonnull__(2, 3)
 ;
 
 /**
- * Rebalance a subtree
+ * Restore the AVL property at a node
  *
- * This function will recursively rebalance a subtree.
- * It uses the metadata of a subtree's root node to check whether the subtree
- * already is balanced. This way, unnecessary recursions are omitted.
+ * The subtrees of the node are expected to be balanced. If their heights differ
+ * by more than one, the node is rotated (twice, if necessary). The metadata of
+ * the node is regenerated. For a node which was balanced before one of its
+ * subtrees grew or shrunk by one level, at most two rotations are performed.
  *
- * @return new root
+ * The heights of the subtrees may differ by any amount, the node is rotated
+ * down the higher one as far as necessary. Hence, two trees are joined by
+ * balancing a node which separates them.
+ *
+ * @return the link to the new root
  */
-struct avl_el*
-rebalance_subtree(
-    struct avl_el* root //!< The root of the subtree to rebalance
+avl_link
+balance_node(
+    avl_link root, //!< The link to the node to balance
+    struct pool const* pool //!< The pool the nodes were allocated from
 )
 __r_warn_unused_result__
 ;
 
+/**
+ * Balance the nodes along a path, bottom up
+ *
+ * `path` holds the links followed from the root of a tree down to a node
+ * which was added or removed. Each of the nodes linked is passed to
+ * balance_node(), starting with the lowest one.
+ */
+void
+rebalance_path(
+    avl_link* const* path, //!< The links, starting at the root
+    size_t depth, //!< The number of links in `path`
+    struct pool const* pool //!< The pool the nodes were allocated from
+)
+;
+
 /**
  * Rotate a node counter-clockwise
  *
- * @return new root or NULL, if the rotation could not be performed
+ * @return the link to the new root, which is `root` if the rotation could not
+ *         be performed
  */
-struct avl_el*
+avl_link
 rotate_left(
-    struct avl_el* node //!< The node to rotate
+    avl_link root, //!< The link to the node to rotate
+    struct pool const* pool //!< The pool the nodes were allocated from
 )
-__r_nonnull__(1)
 __r_warn_unused_result__
 ;
 
 /**
  * Rotate a node clockwise
  *
- * @return new root or NULL, if the rotation could not be performed
+ * @return the link to the new root, which is `root` if the rotation could not
+ *         be performed
  */
-struct avl_el*
+avl_link
 rotate_right(
-    struct avl_el* node //!< The node to rotate
+    avl_link root, //!< The link to the node to rotate
+    struct pool const* pool //!< The pool the nodes were allocated from
 )
-__r_nonnull__(1)
 __r_warn_unused_result__
 ;
 
 /**
  * Isolate the root node of a given subtree
  *
- * @return the new root node of the subtree
+ * @return the link to the new root node of the subtree
  * @warning This function will crash when being passed NULL.
  */
-struct avl_el*
+avl_link
 isolate_root_node(
-    struct avl_el* node //!< node to isolate
+    struct avl_el* node, //!< node to isolate
+    struct pool const* pool //!< The pool the nodes were allocated from
 )
 __r_nonnull__(1)
 __r_warn_unused_result__
@@ -81,20 +125,22 @@ __r_nonnull__(1)
  *
  * This function will isolate the node with the lowest key from the rest of the
  * given subtree. The lowest key, in this implementation, is the leftmost node.
- * The isolated node will be returned.
+ * The isolated node will be returned. The nodes on the path to the isolated
+ * node are rebalanced.
  *
- * @return node with lowest key, or NULL
+ * @return the link to the node with lowest key, or AVL_NO_LINK
  */
-struct avl_el*
+avl_link
 isolate_leftmost(
-    struct avl_el** root //!< Pointer to the root of the affected subtree
+    avl_link* root, //!< Pointer to the root of the affected subtree
+    struct pool const* pool //!< The pool the nodes were allocated from
 )
 __r_nonnull__(1)
 __r_warn_unused_result__
 ;
 
 /**
- * Regenerate a node's height and node_cnt
+ * Regenerate a node's height and bloom filter
  *
  * @return void
  * @warning This function will crash when being passed NULL.
@@ -105,11 +151,99 @@ __r_warn_unused_result__
  */
 void
 regen_metadata(
-    struct avl_el* node //!< The node to regenerate
+    struct avl_el* node, //!< The node to regenerate
+    struct pool const* pool //!< The pool the nodes were allocated from
 )
 __r_nonnull__(1)
 ;
 
+/**
+ * Descend into the subtree covering a range of hashes
+ *
+ * @return the root of the smallest subtree containing all the nodes with
+ *         hashes in the range [from, to], or NULL if there are no such nodes
+ */
+struct avl_el*
+cover_range(
+    struct avl_el const* node, //!< The root of the subtree to descend into
+    r_hash from, //!< The lowest hash of the range
+    r_hash to, //!< The highest hash of the range
+    struct pool const* pool //!< The pool the nodes were allocated from
+)
+__r_nonnull__(4)
+__r_warn_unused_result__
+;
+
+/**
+ * Turn a subtree into a vine
+ *
+ * The nodes of the subtree are relinked into a list sorted by hash, using the
+ * right child links. The metadata of the nodes is not updated, since the vine
+ * is expected to be turned into a tree via build_subtree().
+ *
+ * @return a link to the first node of the vine
+ */
+avl_link
+flatten_subtree(
+    avl_link root, //!< The root of the subtree to flatten
+    size_t* cnt, //!< Output for the number of nodes in the vine
+    struct pool const* pool //!< The pool the nodes were allocated from
+)
+__r_nonnull__(2, 3)
+__r_warn_unused_result__
+;
+
+/**
+ * Build a balanced subtree from a vine
+ *
+ * The first `cnt` nodes are taken from the vine, which is advanced
+ * accordingly. The metadata of all the nodes is regenerated.
+ *
+ * @return the link to the root of the new subtree
+ */
+avl_link
+build_subtree(
+    avl_link* vine, //!< The vine, as produced by flatten_subtree()
+    size_t cnt, //!< The number of nodes to take from the vine
+    struct pool const* pool //!< The pool the nodes were allocated from
+)
+__r_nonnull__(1, 3)
+__r_warn_unused_result__
+;
+
+/**
+ * Feed the elements of a subtree within a range of hashes to a function
+ *
+ * The elements are processed in ascending order of their hashes.
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+int
+foreach_in_subtree(
+    struct avl_el const* node, //!< The root of the subtree to iterate over
+    r_hash from, //!< The lowest hash to take into account
+    r_hash to, //!< The highest hash to take into account
+    struct pool const* pool, //!< The pool the nodes were allocated from
+    avl_emitf emitf, //!< The function to feed the elements to
+    void* etc //!< Passed to `emitf`
+)
+__r_nonnull__(4, 5)
+;
+
+/**
+ * Count the elements stored in a subtree
+ *
+ * @return the number of elements in the subtree
+ */
+size_t
+subtree_cardinality(
+    struct avl_el const* root, //!< The root of the subtree to count
+    struct pool const* pool //!< The pool the nodes were allocated from
+)
+__r_nonnull__(2)
+__r_warn_unused_result__
+;
+
 /**
  * Create a new struct avl_el object
  *
@@ -117,12 +251,28 @@ __r_nonnull__(1)
  */
 struct avl_el*
 new_avl_el(
-    r_hash h //!< The hash for the new struct avl_el object
+    r_hash h, //!< The hash for the new struct avl_el object
+    avl_link* link, //!< Output for the link to the new object
+    struct pool* pool //!< The pool to allocate the object from
 )
+__r_nonnull__(2, 3)
 __r_warn_unused_result__
 __r_malloc__
 ;
 
+/**
+ * Release a struct avl_el object
+ *
+ * The elements stored in the node are not released.
+ */
+void
+free_avl_el(
+    avl_link link, //!< The link to the object to release
+    struct pool* pool //!< The pool the object was allocated from
+)
+__r_nonnull__(2)
+;
+
 /**
  * Find a node by it's key/hash
  *
@@ -130,10 +280,11 @@ __r_malloc__
  */
 struct avl_el*
 find_node(
-    struct avl const* avl,
-    r_hash hash
+    struct avl const* avl, //!< The avl to search in
+    r_hash hash, //!< The hash to search for
+    struct pool const* pool //!< The pool the nodes were allocated from
 )
-__r_nonnull__(1)
+__r_nonnull__(1, 3)
 __r_warn_unused_result__
 ;
 
@@ -153,8 +304,10 @@ __r_warn_unused_result__
 struct avl_el*
 find_closest_lower(
     struct avl_el* root, //!< subtree to search in
-    r_hash hash //!< hash to search for
+    r_hash hash, //!< hash to search for
+    struct pool const* pool //!< The pool the nodes were allocated from
 )
+__r_nonnull__(3)
 __r_warn_unused_result__
 ;
 
@@ -174,8 +327,10 @@ __r_warn_unused_result__
 struct avl_el*
 find_closest_greater(
     struct avl_el* root, //!< subtree to search in
-    r_hash hash //!< hash to search for
+    r_hash hash, //!< hash to search for
+    struct pool const* pool //!< The pool the nodes were allocated from
 )
+__r_nonnull__(3)
 __r_warn_unused_result__
 ;
 
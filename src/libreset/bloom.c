@@ -27,20 +27,6 @@
 
 #define bloom_dbg(fmt,...) do { dbg("bloom: "fmt, __VA_ARGS__); } while (0)
 
-/*
- *
- *
- * definitions
- *
- *
- */
-
-/**
- * Number of bits in a bloom filter
- */
-#define BLOOM_BITS (sizeof(bloom)*8)
-
-
 /*
  *
  *
@@ -82,7 +68,14 @@ bloom_from_hash(
 
     unsigned int vars = HASH_VARIANTS;
     while (vars--) {
-        result |= 1 << (hash % BLOOM_BITS);
+        bloom bit = ((bloom) 1) << (hash % BLOOM_BITS);
+
+        // each variant has to set a distinct bit, or the number of common bits
+        // of two filters would not tell anything about common elements
+        while (result & bit) {
+            bit = ((bit << 1) | (bit >> (BLOOM_BITS - 1))) & BLOOM_MASK;
+        }
+        result |= bit;
 
         // transform the hash to generate new variant
         hash /= BLOOM_BITS;
@@ -97,8 +90,9 @@ bloom_may_contain(
     bloom element,
     bloom set
 ) {
-    bloom_dbg("Check whether 0x%zx contains 0x%zx", set, element);
-    return (element & (~set)) == 0;
+    bloom_dbg("Check whether 0x%zx contains 0x%zx", (size_t) set,
+              (size_t) element);
+    return (element & (~set) & BLOOM_MASK) == 0;
 }
 
 int
@@ -106,14 +100,15 @@ bloom_may_have_common(
     bloom a,
     bloom b
 ) {
-    bloom_dbg("Check whether 0x%zx has common with 0x%zx", a, b);
+    bloom_dbg("Check whether 0x%zx has common with 0x%zx", (size_t) a,
+              (size_t) b);
     // calculate the number of bits common to both filters
-    bloom section = a & b;
+    bloom section = a & b & BLOOM_MASK;
 
     // consider "section" to be made up by ints of single bits
     unsigned int width = 1;
 
-    while (width < BLOOM_BITS) {
+    while (width < BITCOUNT(section)) {
         // we need a mask to mask out half of the ints
         bloom mask = erasure_mask(width);
 
@@ -124,8 +119,9 @@ bloom_may_have_common(
         width <<= 1;
     }
 
-    // the resulting number may now be compared to the number of hash variants
-    return section < HASH_VARIANTS;
+    // the resulting number may now be compared to the number of hash variants:
+    // a common element implies at least HASH_VARIANTS common bits
+    return section >= HASH_VARIANTS;
 }
 
 /*
@@ -141,11 +137,11 @@ static bloom
 erasure_mask(
     unsigned int width
 ) {
-    // we select the 2nd integer, starting from the least significant
-    bloom mask = ((((size_t) 1) << width) - 1) << width;
+    // we select the least significant integer
+    bloom mask = (((bloom) 1) << width) - 1;
 
     // we add that pattern until the mask is filled
-    for (unsigned int pos = BLOOM_BITS / (2 * width); pos; --pos) {
+    for (unsigned int pos = BITCOUNT(mask) / (2 * width); pos > 1; --pos) {
         mask |= mask << (2 * width);
     }
 
@@ -33,16 +33,47 @@
 #define __BLOOM_H__
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "libreset/attributes.h"
 #include "libreset/hash.h"
+#include "util/macros.h"
 
+#ifdef INDEX_LINKS
+/**
+ * Bloom filter type
+ *
+ * The bloom filter is a probabilistic set representation used for speedups.
+ * With `INDEX_LINKS`, it is narrowed to 32 bits for the nodes of the avls to
+ * fit in 32 bytes.
+ */
+typedef uint32_t bloom;
+#else
 /**
  * Bloom filter type
  *
  * The bloom filter is a probabilistic set representation used for speedups.
  */
 typedef size_t bloom;
+#endif
+
+/**
+ * Number of most significant bits of a bloom filter not used by the filter
+ *
+ * These bits are left to the user, e.g. the avl keeps the height of a subtree
+ * in them. The functions below ignore them.
+ */
+#define BLOOM_SPARE_BITS (8)
+
+/**
+ * Number of bits used by a bloom filter
+ */
+#define BLOOM_BITS (BITCOUNT((bloom) 0) - BLOOM_SPARE_BITS)
+
+/**
+ * Mask of the bits used by a bloom filter
+ */
+#define BLOOM_MASK LSB_MASK((bloom) BLOOM_BITS)
 
 /**
  * Get the bloom filter for an element with a given hash.
@@ -23,6 +23,7 @@
 #ifndef __COMMON_H__
 #define __COMMON_H__
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "libreset/set.h"
@@ -46,7 +47,44 @@ config_cmp(
     struct r_set_cfg const* a,
     struct r_set_cfg const* b
 ) {
-    return ((a == b) || (a && b && (0 == memcmp(a, b, sizeof(*a)))));
+    // the allocation functions do not affect the elements
+    return ((a == b) || (a && b && (a->hashf == b->hashf) &&
+            (a->cmpf == b->cmpf) && (a->copyf == b->copyf) &&
+            (a->freef == b->freef)));
+}
+
+/**
+ * Allocate memory through the allocation function provided by the user
+ *
+ * @return a pointer to the zero-initialized memory, NULL on failure
+ */
+static inline void*
+cfg_alloc(
+    struct r_set_cfg const* cfg, //!< type information provided by the user
+    size_t size //!< The number of bytes to allocate
+) {
+    if (!cfg->allocf) {
+        return calloc(1, size);
+    }
+
+    void* ptr = cfg->allocf(cfg->alloc_etc, size);
+    return ptr ? memset(ptr, 0, size) : NULL;
+}
+
+/**
+ * Release memory allocated via cfg_alloc()
+ */
+static inline void
+cfg_dealloc(
+    struct r_set_cfg const* cfg, //!< type information provided by the user
+    void* ptr, //!< The memory to release, or NULL
+    size_t size //!< The size the memory was allocated with
+) {
+    if (!cfg->deallocf) {
+        free(ptr);
+    } else if (ptr) {
+        cfg->deallocf(cfg->alloc_etc, ptr, size);
+    }
 }
 
 
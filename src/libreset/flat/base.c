@@ -0,0 +1,80 @@
+#include <stdint.h>
+
+#include "flat/flat.h"
+
+/**
+ * State of a flat tree being built, used by flat_build()
+ */
+struct flat_builder {
+    struct flat const* flat; //!< The flat tree being built
+    r_hash* hashes; //!< The writable hashes of the tree
+    void** data; //!< The writable elements of the tree
+    size_t k; //!< The index of the next entry to fill
+};
+
+/**
+ * Store an element in the next entry of a flat tree being built
+ *
+ * This function is an avl_emitf, taking a struct flat_builder as `etc`. The
+ * elements have to be passed in ascending order of their hashes.
+ *
+ * @return 0
+ */
+static int
+fill_entry(
+    void* etc,
+    r_hash hash,
+    void* data
+) {
+    struct flat_builder* builder = (struct flat_builder*) etc;
+    builder->hashes[builder->k] = hash;
+    builder->data[builder->k] = data;
+    builder->k = flat_next(builder->flat, builder->k);
+    return 0;
+}
+
+void
+flat_build(
+    struct flat* flat,
+    r_hash* hashes,
+    void** data,
+    struct avl const* avl,
+    struct pool const* pool
+) {
+    flat->hashes = hashes;
+    flat->data = data;
+    flat->card = avl->card;
+
+    // the entries are filled in ascending order, starting at the leftmost one
+    struct flat_builder builder = {
+        .flat = flat,
+        .hashes = hashes,
+        .data = data,
+        .k = 1,
+    };
+    while (2 * builder.k <= flat->card) {
+        builder.k *= 2;
+    }
+
+    avl_range_foreach(avl, 0, SIZE_MAX, pool, fill_entry, &builder);
+}
+
+void*
+flat_find(
+    struct flat const* flat,
+    r_hash hash,
+    void const* d,
+    struct r_set_cfg const* cfg
+) {
+    size_t k = flat_lower_bound(flat, hash);
+
+    // elements with equal hashes are stored in consecutive entries
+    while (k && flat->hashes[k] == hash) {
+        if (cfg->cmpf(flat->data[k], d)) {
+            return flat->data[k];
+        }
+        k = flat_next(flat, k);
+    }
+
+    return NULL;
+}
@@ -0,0 +1,218 @@
+/**
+ * @file flat.h
+ *
+ * This is the interface definition for flat trees, the immutable counterpart
+ * of the AVL trees. A flat tree is built once from an avl and only read
+ * afterwards.
+ *
+ * @copyright See the LICENSE file shipped with the repository.
+ */
+
+/*
+ * @addtogroup internal_flat_interface "(internal) Flat tree interface"
+ *
+ * This group contains the definition of the interface for the flat trees,
+ * meaning public (but only for internal use) functions.
+ *
+ * @{
+ */
+
+#ifndef __FLAT_H__
+#define __FLAT_H__
+
+#include "avl/avl.h"
+#include "libreset/attributes.h"
+#include "libreset/hash.h"
+#include "libreset/set.h"
+#include "pool.h"
+
+/**
+ * Flat tree type
+ *
+ * The hashes of the elements are stored in an array, in the order of a breadth
+ * first traversal of a complete binary search tree (Eytzinger layout): the
+ * children of the entry at index `k` are at the indices `2k` and `2k + 1`.
+ * The first levels of the tree thus share a few cache lines, and the entries
+ * a search will visit next are known in advance, so they can be prefetched.
+ * The elements are stored in a second array, parallel to the first one.
+ * Elements with equal hashes are stored in separate entries.
+ *
+ * The entries are at the indices 1 to `card`. The arrays of several flat trees
+ * may overlap at their index 0, which is not part of the tree.
+ */
+struct flat {
+    r_hash const* hashes;   //!< The hashes of the elements
+    void* const* data;      //!< The elements, parallel to `hashes`
+    size_t card;            //!< The number of elements
+};
+
+/**
+ * Build a flat tree from the elements of an avl
+ *
+ * The entries are written to `hashes` and `data` at the indices 1 to the
+ * number of elements in `avl`, which have to be valid.
+ *
+ * @memberof flat
+ */
+void
+flat_build(
+    struct flat* flat, //!< The flat tree to build
+    r_hash* hashes, //!< Storage for the hashes of the elements
+    void** data, //!< Storage for the elements
+    struct avl const* avl, //!< The avl to take the elements from
+    struct pool const* pool //!< The pool the nodes of `avl` were allocated from
+)
+__r_nonnull__(1, 2, 3, 4, 5)
+;
+
+/**
+ * Find an element in a flat tree
+ *
+ * @memberof flat
+ *
+ * @return the element which compares equal to `d`, or NULL
+ */
+void*
+flat_find(
+    struct flat const* flat, //!< The flat tree to search in
+    r_hash hash, //!< The hash of `d`
+    void const* d, //!< The element to compare against
+    struct r_set_cfg const* cfg //!< type information provided by the user
+)
+__r_nonnull__(1, 3, 4)
+__r_warn_unused_result__
+;
+
+/**
+ * Feed the elements within a range of hashes to a function
+ *
+ * The elements are processed in ascending order of their hashes.
+ *
+ * @memberof flat
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+int
+flat_range_foreach(
+    struct flat const* flat, //!< The flat tree to iterate over
+    r_hash from, //!< The lowest hash to take into account
+    r_hash to, //!< The highest hash to take into account
+    avl_emitf emitf, //!< The function to feed the elements to
+    void* etc //!< Passed to `emitf`
+)
+__r_nonnull__(1, 4)
+;
+
+/**
+ * Process selected elements of a flat tree
+ *
+ * The elements are visited in the order they are stored in, which is not the
+ * order of their hashes. See ll_select() for the semantics of the parameters.
+ *
+ * @memberof flat
+ *
+ * @return 0 or the negative value returned by `procf`
+ */
+int
+flat_select(
+    struct flat const* flat, //!< The flat tree to select elements from
+    r_predf pred, //!< The predicate, or NULL for selecting all elements
+    void* pred_etc, //!< Additional information for the predicate function
+    r_procf procf, //!< function processing the selected values
+    void* dest //!< some pointer to pass to the procf
+)
+__r_nonnull__(1, 4)
+;
+
+/**
+ * Get the index of the first entry with a hash not lower than a given one
+ *
+ * The search descends from the root without branching on the comparisons. On
+ * each level, the entries three levels further down are prefetched, as long as
+ * the tree reaches that deep.
+ *
+ * @memberof flat
+ *
+ * @return the index of the entry, or 0 if all hashes are lower than `hash`
+ */
+static inline size_t
+flat_lower_bound(
+    struct flat const* flat, //!< The flat tree to search in
+    r_hash hash //!< The hash to search for
+)
+__r_nonnull__(1)
+__r_warn_unused_result__
+;
+
+/**
+ * Get the index of the entry following another one in the order of the hashes
+ *
+ * @memberof flat
+ *
+ * @return the index of the next entry, or 0 if `k` is the last one
+ */
+static inline size_t
+flat_next(
+    struct flat const* flat, //!< The flat tree
+    size_t k //!< The index of an entry
+)
+__r_nonnull__(1)
+__r_warn_unused_result__
+;
+
+/*
+ *
+ *
+ * inline implementations
+ *
+ *
+ */
+
+static inline size_t
+flat_lower_bound(
+    struct flat const* flat,
+    r_hash hash
+) {
+    size_t k = 1;
+    while (8 * k <= flat->card) {
+        // the 8 entries three levels below are adjacent
+        __builtin_prefetch(flat->hashes + 8 * k);
+        k = 2 * k + (flat->hashes[k] < hash);
+    }
+
+    // the last levels, which have no entries three levels below to prefetch
+    while (k <= flat->card) {
+        k = 2 * k + (flat->hashes[k] < hash);
+    }
+
+    // the lower bound is where we went left for the last time, so we strip
+    // the right turns after it as well as that left turn
+    return k >> (__builtin_ctzll(~(unsigned long long) k) + 1);
+}
+
+static inline size_t
+flat_next(
+    struct flat const* flat,
+    size_t k
+) {
+    // the leftmost entry of the right subtree, if there is one
+    if (2 * k + 1 <= flat->card) {
+        k = 2 * k + 1;
+        while (2 * k <= flat->card) {
+            k = 2 * k;
+        }
+        return k;
+    }
+
+    // else the first ancestor of which we are in the left subtree
+    while (k & 1) {
+        k >>= 1;
+    }
+    return k >> 1;
+}
+
+#endif //__FLAT_H__
+
+/**
+ * @}
+ */
@@ -0,0 +1,21 @@
+#include "flat/flat.h"
+
+int
+flat_range_foreach(
+    struct flat const* flat,
+    r_hash from,
+    r_hash to,
+    avl_emitf emitf,
+    void* etc
+) {
+    size_t k = flat_lower_bound(flat, from);
+    while (k && flat->hashes[k] <= to) {
+        int retval = emitf(etc, flat->hashes[k], flat->data[k]);
+        if (retval) {
+            return retval;
+        }
+        k = flat_next(flat, k);
+    }
+
+    return 0;
+}
@@ -0,0 +1,23 @@
+#include "flat/flat.h"
+
+int
+flat_select(
+    struct flat const* flat,
+    r_predf pred,
+    void* pred_etc,
+    r_procf procf,
+    void* dest
+) {
+    // the order does not matter, so we simply scan the array
+    size_t k;
+    for (k = 1; k <= flat->card; ++k) {
+        if (!pred || pred(flat->data[k], pred_etc)) {
+            int retval = procf(dest, flat->data[k]);
+            if (retval < 0) {
+                return retval;
+            }
+        }
+    }
+
+    return 0;
+}
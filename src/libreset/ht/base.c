@@ -1,53 +1,531 @@
 #include <stdlib.h>
+#include <stdint.h>
 #include <errno.h>
 
 #include "ht/ht.h"
+#include "util/likely.h"
 #include "util/macros.h"
 #include "ht/common.h"
+#include "params.h"
 
 #include "libreset/hash.h"
 
 /**
- * Calculate the bucket index for a hash and a hashtable
+ * Calculate the lowest hash of a bucket
  *
- * @return The index of the hash `hash` in the hashtable `ht`
+ * @return The lowest hash which would be put in the bucket `i` of a hashtable
+ *         with 2^`sizeexp` buckets
+ */
+static inline r_hash
+bucket_start(
+    size_t sizeexp,
+    size_t i
+) {
+    r_hash start = i;
+    return start << (BITCOUNT(start) - sizeexp);
+}
+
+/**
+ * Add a bucket to the bucket statistics of a hashtable
+ */
+static inline void
+count_bucket(
+    struct ht* ht,
+    struct avl const* avl
+) {
+    unsigned int height = avl_height(avl_root(avl, &ht->pool));
+    ht->nover += height > HT_OPT_HEIGHT;
+    ht->nunder += height < HT_OPT_HEIGHT;
+}
+
+/**
+ * Update the bucket statistics of a hashtable after a bucket was modified
+ *
+ * `height` has to be the height of the bucket's AVL before the modification.
+ * Only the current buckets are accounted for, the statistics of buckets which
+ * are still to be migrated are collected during the migration.
+ */
+static inline void
+account_bucket(
+    struct ht* ht,
+    struct avl const* avl,
+    r_hash hash,
+    unsigned int height
+) {
+    if (!ht_is_migrated(ht, hash)) {
+        return;
+    }
+
+    unsigned int new_height = avl_height(avl_root(avl, &ht->pool));
+    ht->nover += (new_height > HT_OPT_HEIGHT) - (height > HT_OPT_HEIGHT);
+    ht->nunder += (new_height < HT_OPT_HEIGHT) - (height < HT_OPT_HEIGHT);
+}
+
+/**
+ * Get the number of old buckets covered by one unit of migration
+ *
+ * @return the number of old buckets migrated at once
  */
 static inline size_t
-bucket_index(
-    struct ht const* ht,
-    r_hash hash
+old_per_unit(
+    struct ht const* ht
+) {
+    return CONSTPOW_TWO(ht->old_sizeexp - MIN(ht->sizeexp, ht->old_sizeexp));
+}
+
+/**
+ * Release the buckets of a hashtable
+ */
+static inline void
+free_buckets(
+    struct ht* ht,
+    struct ht_bucket* buckets, //!< The buckets to release
+    size_t sizeexp //!< Exp. for the number of buckets
+) {
+    pool_free(&ht->pool, buckets, CONSTPOW_TWO(sizeexp) * sizeof(*buckets));
+}
+
+/**
+ * Calculate the size of the memory holding the flat trees of a frozen ht
+ *
+ * The flat trees are followed by the arrays of hashes and elements, which are
+ * shared by all of them. The arrays start with an unused entry, at which the
+ * first flat tree's arrays are based.
+ *
+ * @return The size of the memory, in bytes
+ */
+static inline size_t
+frozen_size(
+    size_t nbuckets, //!< The number of flat trees
+    size_t card //!< The number of elements
+) {
+    return nbuckets * sizeof(struct flat) +
+           (card + 1) * (sizeof(r_hash) + sizeof(void*));
+}
+
+/**
+ * Migrate buckets of a resize in progress
+ *
+ * Migration is performed in units of the coarser of the two bucket sizes. When
+ * growing, the old bucket `i` is split into the new buckets `2i` and `2i+1`.
+ * When shrinking, the old buckets `2i` and `2i+1` are joined into the new
+ * bucket `i`. Since the nodes carry their hashes, no element has to be
+ * rehashed. When the last unit is migrated, the old buckets are released.
+ */
+static void
+migrate(
+    struct ht* ht,
+    size_t n //!< Maximum number of units to migrate
+) {
+    while (ht->old_buckets && n--) {
+        size_t i = ht->migrated;
+        ht_dbg("Migrating unit %zi of %p", i, (void*) ht);
+
+        if (ht->sizeexp > ht->old_sizeexp) {
+            size_t per_unit = CONSTPOW_TWO(ht->sizeexp - ht->old_sizeexp);
+            struct avl* first = &ht->buckets[i * per_unit].avl;
+
+            // split off the upper new buckets one by one
+            *first = ht->old_buckets[i].avl;
+            size_t j = per_unit;
+            while (--j) {
+                size_t k = i * per_unit + j;
+                avl_split(first, &ht->buckets[k].avl,
+                          bucket_start(ht->sizeexp, k), &ht->pool);
+                count_bucket(ht, &ht->buckets[k].avl);
+            }
+            count_bucket(ht, first);
+        } else {
+            size_t per_unit = old_per_unit(ht);
+            struct avl* avl = &ht->buckets[i].avl;
+
+            // join the old buckets one by one
+            *avl = ht->old_buckets[i * per_unit].avl;
+            size_t j;
+            for (j = 1; j < per_unit; ++j) {
+                avl_join(avl, &ht->old_buckets[i * per_unit + j].avl,
+                         &ht->pool);
+            }
+            count_bucket(ht, avl);
+        }
+
+        if (++ht->migrated >= CONSTPOW_TWO(MIN(ht->sizeexp, ht->old_sizeexp))) {
+            ht_dbg("Migration of %p done", (void*) ht);
+            free_buckets(ht, ht->old_buckets, ht->old_sizeexp);
+            ht->old_buckets = NULL;
+        }
+    }
+}
+
+/**
+ * Resize a hashtable
+ *
+ * The new buckets are allocated and the migration of the old ones is started.
+ * Depending on HT_MIGRATION_STEP, the buckets are migrated immediately or
+ * during subsequent modifications.
+ *
+ * @warning must not be called while another resize is in progress
+ *
+ * @return 0 on success, else errno const:
+ *         -ENOMEM - if the new buckets could not be allocated
+ */
+static int
+resize(
+    struct ht* ht,
+    size_t sizeexp //!< Exp., 2 must be raised to, to get the new size
+) {
+    // the buckets are selected by the most significant bits of the hashes
+    if (unlikely(sizeexp >= BITCOUNT((r_hash) 0))) {
+        return -ENOMEM;
+    }
+
+    struct ht_bucket* buckets = pool_alloc(&ht->pool, CONSTPOW_TWO(sizeexp) *
+                                                      sizeof(*buckets));
+    if (!buckets) {
+        return -ENOMEM;
+    }
+    ht_dbg("Resizing %p to %zi buckets", (void*) ht, CONSTPOW_TWO(sizeexp));
+
+    ht->old_buckets = ht->buckets;
+    ht->old_sizeexp = ht->sizeexp;
+    ht->migrated = 0;
+    ht->buckets = buckets;
+    ht->sizeexp = sizeexp;
+    ht->nover = 0;
+    ht->nunder = 0;
+
+    if (HT_MIGRATION_STEP == 0) {
+        migrate(ht, SIZE_MAX);
+    }
+
+    return 0;
+}
+
+/**
+ * Shrink a hashtable if most of its buckets are lower than optimal
+ *
+ * The table is never shrunk below the size it was initialized with.
+ */
+static void
+shrink_if_sparse(
+    struct ht* ht
+) {
+    if (ht->old_buckets || ht->sizeexp <= ht->minexp) {
+        return;
+    }
+
+    // shrink if only few buckets are of the optimal height or higher
+    size_t nfull = ht_nbuckets(ht) - ht->nunder;
+    if (nfull * HT_SHRINK_DENOM < ht_nbuckets(ht)) {
+        resize(ht, ht->sizeexp - 1); // on failure, we keep the current size
+    }
+}
+
+/**
+ * Complete any resize in progress and grow a hashtable for some elements
+ *
+ * @return 0 on success, else errno const:
+ *         -ENOMEM - if the new buckets could not be allocated
+ */
+static int
+prepare(
+    struct ht* ht,
+    size_t n //!< Expected number of elements
+) {
+    migrate(ht, SIZE_MAX);
+
+    size_t sizeexp = ht_sizeexp_for(n);
+    if (sizeexp <= ht->sizeexp) {
+        return 0;
+    }
+    ht_dbg("Growing %p to %zi buckets", (void*) ht, CONSTPOW_TWO(sizeexp));
+
+    // all elements are moved at once, the table is about to be filled
+    int retval = resize(ht, sizeexp);
+    migrate(ht, SIZE_MAX);
+    return retval;
+}
+
+/**
+ * Insert an element during a bulk session
+ *
+ * @return 0 on success or negative error number on failure (errno.h), like
+ *         ht_insert()
+ */
+static int
+bulk_insert(
+    struct ht* ht,
+    r_hash hash, //!< The hash of `data`
+    void* data, //!< The element to insert
+    struct r_set_cfg const* cfg
 ) {
-    return hash >> (BITCOUNT(hash) - ht->sizeexp);
+    size_t i = ht_bucket_for(ht, hash, NULL) - ht->buckets;
+    int retval = avl_insert_deferred(&ht->buckets[i].avl, hash, data,
+                                     &ht->pool, cfg);
+    if (retval == 0) {
+        ht->touched[i] = 1;
+        ++ht->card;
+    }
+    return retval;
+}
+
+/**
+ * Delete an element during a bulk session
+ *
+ * @return 0 on success or negative error number on failure (errno.h), like
+ *         ht_del()
+ */
+static int
+bulk_del(
+    struct ht* ht,
+    r_hash hash, //!< The hash of `cmp`
+    void const* cmp, //!< Element to compare against
+    struct r_set_cfg const* cfg
+) {
+    size_t i = ht_bucket_for(ht, hash, NULL) - ht->buckets;
+    int retval = avl_del_deferred(&ht->buckets[i].avl, hash, cmp, &ht->pool,
+                                  cfg);
+    if (retval == 0) {
+        ht->touched[i] = 1;
+        --ht->card;
+    }
+    return retval;
 }
 
 struct ht*
 ht_init(
     struct ht* ht,
-    size_t n
+    size_t n,
+    struct r_set_cfg const* cfg
 ) {
     if (ht) {
-        ht->buckets = calloc(CONSTPOW_TWO(n), sizeof(*ht->buckets));
+        pool_init(&ht->pool, cfg);
+        ht->buckets = pool_alloc(&ht->pool, CONSTPOW_TWO(n) *
+                                            sizeof(*ht->buckets));
+        if (!ht->buckets) {
+            return NULL;
+        }
         ht->sizeexp = n;
+        ht->card = 0;
+        ht->minexp = n;
+        ht->nover = 0;
+        ht->nunder = CONSTPOW_TWO(n);
+        ht->old_buckets = NULL;
+        ht->frozen = NULL;
+        ht->touched = NULL;
         ht_dbg("Allocated %zi buckets for %p", CONSTPOW_TWO(n), (void*) ht);
     }
 
     return ht;
 }
 
+int
+ht_reserve(
+    struct ht* ht,
+    size_t n
+) {
+    int retval = prepare(ht, n);
+    if (retval < 0) {
+        return retval;
+    }
+
+    ht->minexp = MAX(ht->minexp, ht_sizeexp_for(n));
+    return 0;
+}
+
+int
+ht_freeze(
+    struct ht* ht,
+    struct r_set_cfg const* cfg
+) {
+    if (ht->frozen) {
+        return 0;
+    }
+
+    migrate(ht, SIZE_MAX);
+
+    size_t nbuckets = ht_nbuckets(ht);
+    struct flat* frozen = cfg_alloc(cfg, frozen_size(nbuckets, ht->card));
+    if (!frozen) {
+        return -ENOMEM;
+    }
+    ht_dbg("Freezing %p with %zi elements", (void*) ht, ht->card);
+
+    // the flat trees are laid out one after the other, in order of the hashes
+    r_hash* hashes = (r_hash*) (frozen + nbuckets);
+    void** data = (void**) (hashes + ht->card + 1);
+    size_t i;
+    for (i = 0; i < nbuckets; ++i) {
+        struct avl const* avl = &ht->buckets[i].avl;
+        flat_build(&frozen[i], hashes, data, avl, &ht->pool);
+        hashes += avl->card;
+        data += avl->card;
+    }
+
+    // the nodes are released along with the pool
+    free_buckets(ht, ht->buckets, ht->sizeexp);
+    pool_destroy(&ht->pool);
+    ht->buckets = NULL;
+    ht->frozen = frozen;
+    return 0;
+}
+
+int
+ht_compact(
+    struct ht* ht,
+    struct r_set_cfg const* cfg
+) {
+    if (ht->frozen) {
+        return 0;
+    }
+
+    migrate(ht, SIZE_MAX);
+
+    size_t size = ht_nbuckets(ht) * sizeof(*ht->buckets);
+    struct pool pool;
+    pool_init(&pool, cfg);
+
+    // the elements are shared with the copies rather than copied themselves
+    int retval = -ENOMEM;
+    struct ht_bucket* buckets = pool_alloc(&pool, size);
+    if (buckets) {
+        size_t i;
+        for (i = 0; i < ht_nbuckets(ht); ++i) {
+            retval = avl_copy(&buckets[i].avl, &ht->buckets[i].avl, &ht->pool,
+                              &pool);
+            if (retval < 0) {
+                break;
+            }
+        }
+    }
+
+    if (retval < 0) {
+        if (buckets) {
+            pool_free(&pool, buckets, size);
+        }
+        pool_destroy(&pool);
+        return retval;
+    }
+    ht_dbg("Compacted %p with %zi elements", (void*) ht, ht->card);
+
+    // the old nodes are released along with their pool
+    free_buckets(ht, ht->buckets, ht->sizeexp);
+    pool_destroy(&ht->pool);
+    ht->pool = pool;
+    ht->buckets = buckets;
+
+    // the AVLs may have become lower
+    size_t i;
+    ht->nover = 0;
+    ht->nunder = 0;
+    for (i = 0; i < ht_nbuckets(ht); ++i) {
+        count_bucket(ht, &ht->buckets[i].avl);
+    }
+
+    return 0;
+}
+
+int
+ht_begin_bulk(
+    struct ht* ht,
+    struct r_set_cfg const* cfg
+) {
+    if (ht->touched) {
+        return 0;
+    }
+
+    // buckets are marked by their index, which must not change
+    migrate(ht, SIZE_MAX);
+    ht->touched = cfg_alloc(cfg, ht_nbuckets(ht));
+    if (!ht->touched) {
+        return -ENOMEM;
+    }
+
+    ht_dbg("Started bulk session on %p", (void*) ht);
+    return 0;
+}
+
+void
+ht_end_bulk(
+    struct ht* ht,
+    struct r_set_cfg const* cfg
+) {
+    if (!ht->touched) {
+        return;
+    }
+
+    size_t i;
+    ht->nover = 0;
+    ht->nunder = 0;
+    for (i = 0; i < ht_nbuckets(ht); ++i) {
+        struct avl* avl = &ht->buckets[i].avl;
+        if (ht->touched[i]) {
+            avl_rebalance(avl, &ht->pool);
+        }
+        count_bucket(ht, avl);
+    }
+
+    cfg_dealloc(cfg, ht->touched, ht_nbuckets(ht));
+    ht->touched = NULL;
+    ht_dbg("Ended bulk session on %p", (void*) ht);
+
+    // catch up on the resizes skipped during the session, by the same rule as
+    // ht_insert(), on failure we just keep the current size
+    while ((ht->nover * HT_GROW_DENOM > ht_nbuckets(ht)) &&
+           (resize(ht, ht->sizeexp + 1) == 0)) {
+        migrate(ht, SIZE_MAX);
+    }
+    shrink_if_sparse(ht);
+}
+
 int
 ht_destroy(
     struct ht* ht,
     struct r_set_cfg const* cfg
 ) {
-    if (ht) {
-        size_t i = ht_nbuckets(ht);
-        ht_dbg("Destroying %p with %zi buckets", (void*) ht, i);
-        while (i--) {
-            avl_destroy(&ht->buckets[i].avl, cfg); // ignore EEXIST here
+    // a bulk session may still be in progress
+    cfg_dealloc(cfg, ht->touched, ht_nbuckets(ht));
+    ht->touched = NULL;
+
+    if (ht->frozen) {
+        ht_dbg("Destroying frozen %p", (void*) ht);
+
+        // the elements of all flat trees are stored in one array
+        if (cfg->freef) {
+            size_t k;
+            for (k = 1; k <= ht->card; ++k) {
+                cfg->freef(ht->frozen->data[k]);
+            }
         }
-        free(ht->buckets);
+
+        cfg_dealloc(cfg, ht->frozen, frozen_size(ht_nbuckets(ht), ht->card));
+        ht->frozen = NULL;
     } else {
-        return -EEXIST;
+        ht_dbg("Destroying %p with %zi buckets", (void*) ht, ht_nbuckets(ht));
+
+        // all nodes are released along with the pool, hence the elements only
+        // have to be visited if they have to be freed
+        if (cfg->freef) {
+            size_t i = ht_nbuckets(ht);
+            while (i--) {
+                // ignore EEXIST here
+                avl_destroy(&ht->buckets[i].avl, &ht->pool, cfg);
+            }
+
+            // the old buckets of a resize in progress may hold elements, too
+            if (ht->old_buckets) {
+                i = CONSTPOW_TWO(ht->old_sizeexp);
+                while (i-- > ht->migrated * old_per_unit(ht)) {
+                    avl_destroy(&ht->old_buckets[i].avl, &ht->pool, cfg);
+                }
+            }
+        }
+
+        free_buckets(ht, ht->buckets, ht->sizeexp);
+        if (ht->old_buckets) {
+            free_buckets(ht, ht->old_buckets, ht->old_sizeexp);
+        }
+        pool_destroy(&ht->pool);
     }
     return 0;
 }
@@ -59,9 +537,25 @@ ht_del(
     struct r_set_cfg const* cfg
 ) {
     r_hash hash = cfg->hashf(cmp);
-    size_t i = bucket_index(ht, hash);
-    ht_dbg("Deleting element with hash %zi in bucket %zi", hash, i);
-    return avl_del(&ht->buckets[i].avl, hash, cmp, cfg);
+    if (ht->touched) {
+        return bulk_del(ht, hash, cmp, cfg);
+    }
+
+    migrate(ht, HT_MIGRATION_STEP);
+
+    struct avl* avl = &ht_bucket_for(ht, hash, NULL)->avl;
+    ht_dbg("Deleting element with hash %zi in bucket %p", hash, (void*) avl);
+
+    unsigned int height = avl_height(avl_root(avl, &ht->pool));
+    int retval = avl_del(avl, hash, cmp, &ht->pool, cfg);
+    account_bucket(ht, avl, hash, height);
+    if (retval == 0) {
+        --ht->card;
+    }
+
+    shrink_if_sparse(ht);
+
+    return retval;
 }
 
 void*
@@ -70,10 +564,23 @@ ht_find(
     void const* cmp,
     struct r_set_cfg const* cfg
 ) {
-    r_hash hash = cfg->hashf(cmp);
-    size_t i = bucket_index(ht, hash);
-    ht_dbg("Finding element with hash %zi in bucket %zi", hash, i);
-    return avl_find(&ht->buckets[i].avl, hash, cmp, cfg);
+    return ht_find_hash(ht, cfg->hashf(cmp), cmp, cfg);
+}
+
+void*
+ht_find_hash(
+    struct ht const* ht,
+    r_hash hash,
+    void const* cmp,
+    struct r_set_cfg const* cfg
+) {
+    if (ht->frozen) {
+        return flat_find(ht_flat_for(ht, hash, NULL), hash, cmp, cfg);
+    }
+
+    struct avl* avl = &ht_bucket_for(ht, hash, NULL)->avl;
+    ht_dbg("Finding element with hash %zi in bucket %p", hash, (void*) avl);
+    return avl_find(avl, hash, cmp, &ht->pool, cfg);
 }
 
 unsigned int
@@ -83,15 +590,99 @@ ht_ndel(
     void* etc,
     struct r_set_cfg const* cfg
 ) {
-    size_t i;
     unsigned int sum = 0;
+    r_hash hash = 0;
+    r_hash last;
 
     ht_dbg("Delete elements in %zi buckets matching %p", ht_nbuckets(ht), etc);
 
-    for (i = 0; i < ht_nbuckets(ht); i++) {
-        sum += avl_ndel(&ht->buckets[i].avl, pred, etc, cfg);
+    do {
+        struct avl* avl = &ht_bucket_for(ht, hash, &last)->avl;
+        unsigned int height = avl_height(avl_root(avl, &ht->pool));
+        sum += avl_ndel(avl, pred, etc, &ht->pool, cfg);
+        account_bucket(ht, avl, hash, height);
+        hash = last + 1;
+    } while (hash);
+    ht->card -= sum;
+
+    shrink_if_sparse(ht);
+
+    return sum;
+}
+
+/**
+ * Lookup of elements in another hashtable, used by ht_ndel_other()
+ */
+struct other_ht {
+    struct ht const* ht; //!< The hashtable to look the elements up in
+    int common; //!< Whether to select the common elements or the others
+    struct r_set_cfg const* cfg; //!< type information provided by the user
+};
+
+/**
+ * Select an element by its presence in another hashtable
+ *
+ * This function is a r_predf, taking a struct other_ht as `etc`.
+ *
+ * @return 1 if the element is selected, else 0
+ */
+static int
+select_by_other_ht(
+    void const* data,
+    void* etc
+) {
+    struct other_ht const* other = (struct other_ht const*) etc;
+    int found = ht_find(other->ht, data, other->cfg) != NULL;
+    return found == !!other->common;
+}
+
+size_t
+ht_ndel_other(
+    struct ht* ht,
+    struct ht const* other,
+    int common,
+    struct r_set_cfg const* cfg
+) {
+    size_t sum = 0;
+    r_hash hash = 0;
+    r_hash last;
+
+    ht_dbg("Delete elements of %p by their presence in %p", (void*) ht,
+           (void*) other);
+
+    // a frozen hashtable has no buckets to pair ours with
+    if (other->frozen) {
+        struct other_ht lookup = { .ht = other, .common = common, .cfg = cfg };
+        return ht_ndel(ht, select_by_other_ht, &lookup, cfg);
     }
 
+    do {
+        struct avl* avl = &ht_bucket_for(ht, hash, &last)->avl;
+        unsigned int height = avl_height(avl_root(avl, &ht->pool));
+        r_hash from = hash;
+
+        // the bucket may span several buckets of the other hashtable
+        while (1) {
+            r_hash last_other;
+            struct avl const* avl_other =
+                    &ht_bucket_for(other, hash, &last_other)->avl;
+            r_hash to = MIN(last, last_other);
+
+            sum += avl_range_ndel_other(avl, avl_other, hash, to, common,
+                                        &ht->pool, &other->pool, cfg);
+            if (to == last) {
+                break;
+            }
+            hash = to + 1;
+        }
+
+        account_bucket(ht, avl, from, height);
+        hash = last + 1;
+    } while (hash);
+    ht->card -= sum;
+
+    shrink_if_sparse(ht);
+
     return sum;
 }
 
@@ -102,10 +693,67 @@ ht_insert(
     struct r_set_cfg const* cfg
 ) {
     r_hash hash = cfg->hashf(data);
+    if (ht->touched) {
+        return bulk_insert(ht, hash, data, cfg);
+    }
+
+    migrate(ht, HT_MIGRATION_STEP);
+
+    struct avl* avl = &ht_bucket_for(ht, hash, NULL)->avl;
+    ht_dbg("Adding element %p with hash %zi in bucket %p", data, hash,
+           (void*) avl);
+
+    unsigned int height = avl_height(avl_root(avl, &ht->pool));
+    int retval = avl_insert(avl, hash, data, &ht->pool, cfg);
+    account_bucket(ht, avl, hash, height);
+    if (retval == 0) {
+        ++ht->card;
+    }
+
+    // resize if too many buckets exceed the optimal height (see paper), but
+    // never start a resize while another one is in progress
+    if (!ht->old_buckets && (ht->nover * HT_GROW_DENOM > ht_nbuckets(ht))) {
+        // on failure, we just keep the current size
+        resize(ht, ht->sizeexp + 1);
+    }
+
+    return retval;
+}
+
+int
+ht_merge(
+    struct ht* dest,
+    ht_rangef rangef,
+    void* etc,
+    size_t n,
+    struct r_set_cfg const* cfg
+) {
+    int retval = prepare(dest, dest->card + n);
+    if (retval < 0) {
+        return retval;
+    }
+
+    ht_dbg("Merging elements into %p", (void*) dest);
+
+    size_t i;
+    for (i = 0; (retval >= 0) && (i < ht_nbuckets(dest)); ++i) {
+        struct avl* avl = &dest->buckets[i].avl;
+        r_hash from = bucket_start(dest->sizeexp, i);
+        r_hash to = bucket_start(dest->sizeexp, i + 1) - 1; // wraps for last
+
+        unsigned int height = avl_height(avl_root(avl, &dest->pool));
+        size_t card = avl->card;
+
+        struct avl_builder builder;
+        avl_build_begin(&builder, avl, &dest->pool, cfg);
+        retval = rangef(etc, from, to, avl_build_add, &builder);
+        avl_build_end(&builder);
+
+        account_bucket(dest, avl, from, height);
+        dest->card += avl->card - card;
+    }
 
-    // this is equivalent to hash / 2^(BITCOUNT(hash) - ht->sizeexp) due to the
-    // right shift
-    size_t i = bucket_index(ht, hash);
-    ht_dbg("Adding element %p with hash %zi in bucket %zi", data, hash, i);
-    return avl_insert(&ht->buckets[i].avl, hash, data, cfg);
+    // the merged elements may exceed the capacity of the buckets
+    int grown = prepare(dest, dest->card);
+    return retval < 0 ? retval : grown;
 }
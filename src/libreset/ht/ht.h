@@ -36,6 +36,9 @@
 #include "libreset/set.h"
 
 #include "avl/avl.h"
+#include "flat/flat.h"
+#include "params.h"
+#include "pool.h"
 #include "util/macros.h"
 
 /**
@@ -46,19 +49,65 @@ struct ht_bucket {
     struct avl avl;
 };
 
+/**
+ * Function type for producing the elements of a range of hashes
+ *
+ * A function of this type feeds the elements with hashes in the range
+ * [`from`, `to`] to `emitf`, passing `emit_etc` along. The elements are fed in
+ * one or more runs, each in ascending order of the hashes, e.g. one run per
+ * operand of a set operation. ht_merge() restarts the search for the position
+ * of an element at the start of each run, so a single run is the fastest.
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+typedef int (*ht_rangef)(
+    void* etc,
+    r_hash from,
+    r_hash to,
+    avl_emitf emitf,
+    void* emit_etc
+);
+
 /**
  * Hashtable type
  *
  * The type for the hashtable, holding buckets and size.
+ *
+ * While the hashtable is being resized, the buckets of the previous size are
+ * kept in `old_buckets` until all of them are migrated. Buckets are migrated
+ * in ascending order, hence the elements with hashes lower than a certain
+ * threshold reside in `buckets` while the others still reside in
+ * `old_buckets`. Use ht_bucket_for() to locate the bucket for a hash.
+ *
+ * A frozen hashtable holds its elements in flat trees instead of AVLs, one per
+ * bucket, and has neither `buckets` nor nodes in its pool. It can not be
+ * modified any more. Use ht_flat_for() to locate the flat tree for a hash.
+ *
+ * During a bulk session, the AVLs are modified without rebalancing them, and
+ * the buckets modified are marked in `touched`. The hashtable is not resized
+ * before the session ends.
  */
 struct ht {
     struct ht_bucket* buckets; //!< The buckets of the hashtable
     size_t sizeexp; //!< Exp., 2 must be raised to, to get the size of the ht
+    size_t card; //!< The number of elements in the ht
+    size_t minexp; //!< Exp. for the minimum number of buckets
+    size_t nover; //!< Number of buckets holding AVLs higher than optimal
+    size_t nunder; //!< Number of buckets holding AVLs lower than optimal
+    struct ht_bucket* old_buckets; //!< Buckets still to migrate, or NULL
+    size_t old_sizeexp; //!< Exp. for the number of old buckets
+    size_t migrated; //!< Number of migrated hash ranges
+    struct pool pool; //!< The pool the nodes of the AVLs are allocated from
+    struct flat* frozen; //!< The buckets of a frozen ht, or NULL
+    unsigned char* touched; //!< Buckets modified in a bulk session, or NULL
 };
 
 /**
  * Initialize a struct ht object
  *
+ * All memory of the hashtable is allocated via the allocation functions of the
+ * configuration `cfg`, which must be passed to all operations on the ht.
+ *
  * @memberof ht
  *
  * @return the pointer to the passed struct ht object, NULL on failure
@@ -66,18 +115,41 @@ struct ht {
 struct ht*
 ht_init(
     struct ht* ht, //!< The hashtable object to initialize
-    size_t n //!< Power, 2 must be raised to, to calc the number of buckets.
+    size_t n, //!< Power, 2 must be raised to, to calc the number of buckets.
+    struct r_set_cfg const* cfg //!< type information provided by the user
 )
+__r_nonnull__(3)
 __r_warn_unused_result__
 ;
 
 /**
- * Destroy a struct ht object but don't free it
+ * Reserve buckets for an expected number of elements
+ *
+ * The hashtable is resized to the number of buckets returned by
+ * ht_sizeexp_for(), if it has fewer buckets. Any resize in progress is
+ * completed first. The hashtable will not shrink below the reserved size.
  *
  * @memberof ht
  *
  * @return 0 on success, else errno const:
- *         -EEXIST - if the ht doesn't exist (NULL passed, no buckets)
+ *         -ENOMEM - if the buckets could not be allocated
+ */
+int
+ht_reserve(
+    struct ht* ht, //!< The hashtable object to reserve buckets in
+    size_t n //!< Expected number of elements
+)
+__r_nonnull__(1)
+;
+
+/**
+ * Destroy a struct ht object but don't free it
+ *
+ * The elements are only visited if `cfg` provides a `freef`.
+ *
+ * @memberof ht
+ *
+ * @return 0
  */
 int
 ht_destroy(
@@ -87,10 +159,98 @@ ht_destroy(
 __r_nonnull__(1, 2)
 ;
 
+/**
+ * Turn a hashtable into a frozen one
+ *
+ * Any resize in progress is completed first. The elements of each bucket are
+ * then copied to a flat tree and the AVLs are released. If the hashtable is
+ * already frozen, nothing is done.
+ *
+ * @memberof ht
+ *
+ * @return 0 on success, else errno const:
+ *         -ENOMEM - if the flat trees could not be allocated, in which case the
+ *                   hashtable is left unchanged
+ */
+int
+ht_freeze(
+    struct ht* ht, //!< The hashtable object to freeze
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 2)
+;
+
+/**
+ * Rearrange the nodes of a hashtable in memory
+ *
+ * Any resize in progress is completed first. The AVLs of all buckets are then
+ * copied to a new pool, one after another, and the old pool is released. The
+ * nodes of each bucket thus end up next to each other, in ascending order of
+ * their hashes, and the AVLs end up balanced perfectly. If the hashtable is
+ * frozen, nothing is done.
+ *
+ * @memberof ht
+ *
+ * @return 0 on success, else errno const:
+ *         -ENOMEM - if the nodes could not be allocated, in which case the
+ *                   hashtable is left unchanged
+ */
+int
+ht_compact(
+    struct ht* ht, //!< The hashtable object to compact
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 2)
+;
+
+/**
+ * Start a bulk session on a hashtable
+ *
+ * Any resize in progress is completed first. Until ht_end_bulk() is called,
+ * ht_insert() and ht_del() only link and unlink nodes, without rebalancing the
+ * AVLs or resizing the hashtable. The AVLs remain valid search trees with
+ * conservative bloom filters, hence lookups and iterations are still possible,
+ * but no other modifications. If a session is in progress already, nothing is
+ * done.
+ *
+ * @memberof ht
+ *
+ * @return 0 on success, else errno const:
+ *         -ENOMEM - if the session could not be started
+ */
+int
+ht_begin_bulk(
+    struct ht* ht, //!< The hashtable object to start the session for
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 2)
+;
+
+/**
+ * End a bulk session on a hashtable
+ *
+ * Each AVL modified during the session is rebalanced once, regenerating the
+ * metadata of its nodes. The hashtable is then resized if necessary. If no
+ * session is in progress, nothing is done.
+ *
+ * @memberof ht
+ */
+void
+ht_end_bulk(
+    struct ht* ht, //!< The hashtable object to end the session for
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 2)
+;
+
 /**
  * Find an element inside the hashtable by its hash and the predicate provided
  * by `cfg`
  *
+ * Lookups do not modify the hashtable. During a resize, they look the element
+ * up in the old or the new buckets, but do not migrate any of them. Only
+ * insertions and removals advance the migration.
+ *
  * @memberof ht
  *
  * @return the found element or NULL on failure
@@ -105,6 +265,24 @@ __r_nonnull__(1, 2, 3)
 __r_warn_unused_result__
 ;
 
+/**
+ * Find an element inside the hashtable, given its hash
+ *
+ * @memberof ht
+ *
+ * @return the found element or NULL on failure
+ */
+void*
+ht_find_hash(
+    struct ht const* ht, //!< The hashtable object to search in
+    r_hash hash, //!< The hash of `cmp`
+    void const* cmp, //!< Element to compare against
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 3, 4)
+__r_warn_unused_result__
+;
+
 /**
  * Insert data into the hashtable
  *
@@ -123,6 +301,32 @@ ht_insert(
 __r_nonnull__(1, 2, 3)
 ;
 
+/**
+ * Insert several elements into the hashtable at once
+ *
+ * The hashes of all the elements are computed up front and the elements are
+ * radix sorted by them, which puts them in the order of the buckets. The
+ * hashtable is then grown for holding all of them, and the elements are merged
+ * into each bucket via ht_merge(), which rebuilds the bucket's AVL once.
+ * Elements already in the hashtable, as well as duplicates within `elems`, are
+ * skipped.
+ *
+ * @memberof ht
+ *
+ * @return 0 on success or negative error number on failure (errno.h)
+ *         -ENOMEM - on allocation failed, in which case only some of the
+ *                   elements may have been inserted
+ */
+int
+ht_insert_bulk(
+    struct ht* ht, //!< The hashtable object to insert into
+    void* const* elems, //!< The elements to insert
+    size_t n, //!< The number of elements in `elems`
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 4)
+;
+
 /**
  * Delete one element from the hashtable by hash and the predicate provided by
  * `cfg`
@@ -173,6 +377,30 @@ ht_ndel(
 __r_nonnull__(1, 3, 4)
 ;
 
+/**
+ * Delete elements from the hashtable by their presence in another one
+ *
+ * If `common` is non-zero, the elements which are also in `other` are removed,
+ * else the ones which are not in `other`. The buckets are paired by the hash
+ * ranges they cover, hence no hashes are computed. Only if `other` is frozen,
+ * the elements are hashed and looked up one by one.
+ *
+ * @warning `other` must not be `ht`
+ *
+ * @memberof ht
+ *
+ * @return the number of removed elements
+ */
+size_t
+ht_ndel_other(
+    struct ht* ht, //!< The hashtable object to delete from
+    struct ht const* other, //!< The hashtable to look the elements up in
+    int common, //!< Whether to delete the common elements or the others
+    struct r_set_cfg const* cfg //!< type information provided by the user
+)
+__r_nonnull__(1, 2, 4)
+;
+
 /**
  * Select entries from a ht into a new one
  *
@@ -207,6 +435,280 @@ ht_equal(
 __r_nonnull__(1, 2)
 ;
 
+/**
+ * Check if a hashtable object is a subset of another one
+ *
+ * The buckets are paired by the hash ranges they cover, hence the hashtables
+ * may differ in size.
+ *
+ * @memberof ht
+ *
+ * @return 1 if `a` is a subset of `b`, else 0 (zero)
+ */
+int
+ht_is_subset(
+    struct ht const* a, //!< The hashtable which may be the subset
+    struct ht const* b, //!< The hashtable which may be the superset
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 2, 3)
+;
+
+/**
+ * Feed the elements within a range of hashes to a function
+ *
+ * The elements are processed in ascending order of their hashes.
+ *
+ * @memberof ht
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+int
+ht_range_foreach(
+    struct ht const* ht, //!< The hashtable object to iterate over
+    r_hash from, //!< The lowest hash to take into account
+    r_hash to, //!< The highest hash to take into account
+    avl_emitf emitf, //!< The function to feed the elements to
+    void* etc //!< Passed to `emitf`
+)
+__r_nonnull__(1, 4)
+;
+
+/**
+ * Feed the elements within a range of hashes selected by a lookup to a function
+ *
+ * Each element of `ht` within the range is looked up in the hashtables
+ * `others`. If `common` is 1, the elements which are in all of them are
+ * processed, if it is 0, the elements which are in none of them. The elements
+ * are processed in ascending order of their hashes.
+ *
+ * Unlike the bucket-wise operations, this works for frozen hashtables.
+ *
+ * @memberof ht
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+int
+ht_range_foreach_lookup(
+    struct ht const* ht, //!< The hashtable object to take the elements from
+    struct ht const* const* others, //!< The hashtables to look them up in
+    size_t n, //!< The number of hashtables in `others`
+    r_hash from, //!< The lowest hash to take into account
+    r_hash to, //!< The highest hash to take into account
+    int common, //!< Whether to process the common elements or the others
+    struct r_set_cfg const* cfg, //!< type information provided by user
+    avl_emitf emitf, //!< The function to feed the elements to
+    void* etc //!< Passed to `emitf`
+)
+__r_nonnull__(1, 7, 8)
+;
+
+/**
+ * Add elements produced bucket by bucket to a hashtable
+ *
+ * For each bucket of `dest`, `rangef` is called for the range of hashes the
+ * bucket covers. The produced elements are merged into the bucket, which is
+ * rebalanced only once. No hashes are computed. Elements already in `dest`
+ * are skipped.
+ * Before merging, `dest` is grown for holding `n` more elements. After the
+ * merge, it is grown if necessary.
+ *
+ * @warning `rangef` must not access `dest`
+ *
+ * @memberof ht
+ *
+ * @return 0 on success, else a negative error number (errno.h):
+ *         -ENOMEM - on allocation failed
+ */
+int
+ht_merge(
+    struct ht* dest, //!< The hashtable object to merge into
+    ht_rangef rangef, //!< The function producing the elements to merge
+    void* etc, //!< Passed to `rangef`
+    size_t n, //!< Expected number of elements added
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 2, 5)
+;
+
+/**
+ * Compute the union of two hashtables
+ *
+ * All elements of `a` and `b` are added to `dest`. `dest` may be one of the
+ * operands.
+ *
+ * @memberof ht
+ *
+ * @return 0 on success, else a negative error number (errno.h):
+ *         -ENOMEM - on allocation failed
+ */
+int
+ht_union(
+    struct ht* dest, //!< The hashtable object to store the result in
+    struct ht const* a, //!< The first operand
+    struct ht const* b, //!< The second operand
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 2, 3, 4)
+;
+
+/**
+ * Compute the union of several hashtables
+ *
+ * All elements of the hashtables in `hts` are added to `dest`. `dest` may be
+ * one of the operands. Entries of `hts` may be NULL, they are skipped.
+ *
+ * @warning the entries of `hts` aliasing `dest` are set to NULL
+ *
+ * @memberof ht
+ *
+ * @return 0 on success, else a negative error number (errno.h):
+ *         -ENOMEM - on allocation failed
+ */
+int
+ht_union_n(
+    struct ht* dest, //!< The hashtable object to store the result in
+    struct ht const** hts, //!< The operands
+    size_t n, //!< The number of operands
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 4)
+;
+
+/**
+ * Compute the intersection of two hashtables
+ *
+ * All elements which are in both `a` and `b` are added to `dest`. If `dest` is
+ * one of the operands, the elements not in the other one are removed from it
+ * in place.
+ *
+ * @memberof ht
+ *
+ * @return 0 on success, else a negative error number (errno.h):
+ *         -ENOMEM - on allocation failed
+ */
+int
+ht_intersection(
+    struct ht* dest, //!< The hashtable object to store the result in
+    struct ht const* a, //!< The first operand
+    struct ht const* b, //!< The second operand
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 2, 3, 4)
+;
+
+/**
+ * Compute the intersection of several hashtables
+ *
+ * All elements which are in all the hashtables in `hts` are added to `dest`.
+ * The buckets of all the operands are walked at once, taking the elements
+ * from the operand with the fewest elements. If `dest` is one of the
+ * operands, the elements not in the other ones are removed from it in place.
+ *
+ * @warning `hts` is reordered by the cardinality of the operands
+ *
+ * @memberof ht
+ *
+ * @return 0 on success, else a negative error number (errno.h):
+ *         -ENOMEM - on allocation failed
+ *         -EINVAL - if no operand was passed
+ */
+int
+ht_intersection_n(
+    struct ht* dest, //!< The hashtable object to store the result in
+    struct ht const** hts, //!< The operands
+    size_t n, //!< The number of operands
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 4)
+;
+
+/**
+ * Count the elements common to two hashtables
+ *
+ * The elements are counted like ht_intersection() would produce them, but no
+ * memory is allocated.
+ *
+ * @memberof ht
+ *
+ * @return the number of elements which are in both `a` and `b`
+ */
+size_t
+ht_intersection_cardinality(
+    struct ht const* a, //!< The first operand
+    struct ht const* b, //!< The second operand
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 2, 3)
+__r_warn_unused_result__
+;
+
+/**
+ * Check whether two hashtables have no elements in common
+ *
+ * The buckets are walked like in ht_intersection(), stopping at the first
+ * common element.
+ *
+ * @memberof ht
+ *
+ * @return 1 if `a` and `b` are disjoint, else 0 (zero)
+ */
+int
+ht_disjoint(
+    struct ht const* a, //!< The first operand
+    struct ht const* b, //!< The second operand
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 2, 3)
+__r_warn_unused_result__
+;
+
+/**
+ * Compute the difference of two hashtables
+ *
+ * All elements of `a` which are not in `b` are added to `dest`. If `dest` is
+ * `a`, the elements of `b` are removed from it in place. `dest` must not be
+ * `b`.
+ *
+ * @memberof ht
+ *
+ * @return 0 on success, else a negative error number (errno.h):
+ *         -ENOMEM - on allocation failed
+ *         -EINVAL - if `dest` is `b` but not `a`
+ */
+int
+ht_exclude(
+    struct ht* dest, //!< The hashtable object to store the result in
+    struct ht const* a, //!< The operand to take the elements from
+    struct ht const* b, //!< The operand holding the elements to exclude
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 2, 3, 4)
+;
+
+/**
+ * Compute the symmetric difference of two hashtables
+ *
+ * All elements which are in exactly one of `a` and `b` are added to `dest`. If
+ * `dest` is one of the operands, the common elements are removed from it in
+ * place and the elements only in the other operand are merged into it. Only
+ * the latter are buffered.
+ *
+ * @memberof ht
+ *
+ * @return 0 on success, else a negative error number (errno.h):
+ *         -ENOMEM - on allocation failed
+ */
+int
+ht_xor(
+    struct ht* dest, //!< The hashtable object to store the result in
+    struct ht const* a, //!< The first operand
+    struct ht const* b, //!< The second operand
+    struct r_set_cfg const* cfg //!< type information provided by user
+)
+__r_nonnull__(1, 2, 3, 4)
+;
+
 /**
  * Helper to calculate the actual bucket count of the hashtable
  *
@@ -221,6 +723,119 @@ ht_nbuckets(
 __r_warn_unused_result__
 ;
 
+/**
+ * Calculate the number of buckets for an expected number of elements
+ *
+ * The number of buckets is chosen such that each bucket will hold at most
+ * 2^(HT_OPT_HEIGHT - 2) elements on average. Since hashes are not distributed
+ * evenly across the buckets, this leaves enough headroom for most of the AVLs
+ * to stay within the optimal height HT_OPT_HEIGHT, so the hashtable will not
+ * grow while it is filled.
+ *
+ * @memberof ht
+ *
+ * @return Exp., 2 must be raised to, to get the number of buckets
+ */
+static inline size_t
+ht_sizeexp_for(
+    size_t n //!< Expected number of elements
+)
+__r_warn_unused_result__
+;
+
+/**
+ * Check whether the hash range containing a hash was already migrated
+ *
+ * @memberof ht
+ *
+ * @return 1 if the elements with the hash reside in the current buckets, 0 if
+ *         they still reside in the old buckets
+ */
+static inline int
+ht_is_migrated(
+    struct ht const* ht, //!< The ht object to check
+    r_hash hash //!< The hash to check
+)
+__r_nonnull__(1)
+__r_warn_unused_result__
+;
+
+/**
+ * Get the bucket responsible for a hash
+ *
+ * This function takes care of resizes in progress. The returned bucket covers
+ * a range of hashes, the highest of which is written to `last`, if `last` is
+ * not NULL. Iterating over the buckets of a hashtable is done by starting at
+ * the hash 0 and continuing with `last + 1` until it wraps around.
+ *
+ * @warning the hashtable must not be frozen
+ *
+ * @memberof ht
+ *
+ * @return The bucket which may hold elements with the hash `hash`
+ */
+static inline struct ht_bucket*
+ht_bucket_for(
+    struct ht const* ht, //!< The ht object to get the bucket from
+    r_hash hash, //!< The hash to get the bucket for
+    r_hash* last //!< Output for the highest hash covered by the bucket
+)
+__r_nonnull__(1)
+__r_warn_unused_result__
+;
+
+/**
+ * Check whether a hashtable is frozen
+ *
+ * @memberof ht
+ *
+ * @return 1 if the hashtable is frozen, else 0
+ */
+static inline int
+ht_is_frozen(
+    struct ht const* ht //!< The ht object to check
+)
+__r_nonnull__(1)
+__r_warn_unused_result__
+;
+
+/**
+ * Check whether a bulk session is in progress on a hashtable
+ *
+ * @memberof ht
+ *
+ * @return 1 if a bulk session is in progress, else 0
+ */
+static inline int
+ht_in_bulk(
+    struct ht const* ht //!< The ht object to check
+)
+__r_nonnull__(1)
+__r_warn_unused_result__
+;
+
+/**
+ * Get the flat tree of a frozen hashtable responsible for a hash
+ *
+ * Like ht_bucket_for(), the highest hash covered by the flat tree is written
+ * to `last`, if `last` is not NULL.
+ *
+ * @warning the hashtable must be frozen
+ *
+ * @memberof ht
+ *
+ * @return The flat tree which may hold elements with the hash `hash`
+ */
+static inline struct flat const*
+ht_flat_for(
+    struct ht const* ht, //!< The ht object to get the flat tree from
+    r_hash hash, //!< The hash to get the flat tree for
+    r_hash* last //!< Output for the highest hash covered by the flat tree
+)
+__r_nonnull__(1)
+__r_warn_unused_result__
+;
+
 /*
  *
  *
@@ -239,6 +854,79 @@ ht_nbuckets(
     return CONSTPOW_TWO(ht->sizeexp);
 }
 
+static inline size_t
+ht_sizeexp_for(
+    size_t n
+) {
+    size_t sizeexp = 0;
+    while ((n >> sizeexp) > CONSTPOW_TWO(HT_OPT_HEIGHT - 2)) {
+        ++sizeexp;
+    }
+    return sizeexp;
+}
+
+static inline int
+ht_is_migrated(
+    struct ht const* ht,
+    r_hash hash
+) {
+    if (!ht->old_buckets) {
+        return 1;
+    }
+
+    // migration progresses in units of the coarser of the two sizes
+    size_t coarse = MIN(ht->sizeexp, ht->old_sizeexp);
+    return (hash >> (BITCOUNT(hash) - coarse)) < ht->migrated;
+}
+
+static inline struct ht_bucket*
+ht_bucket_for(
+    struct ht const* ht,
+    r_hash hash,
+    r_hash* last
+) {
+    struct ht_bucket* buckets = ht->buckets;
+    size_t shift = BITCOUNT(hash) - ht->sizeexp;
+
+    if (!ht_is_migrated(ht, hash)) {
+        buckets = ht->old_buckets;
+        shift = BITCOUNT(hash) - ht->old_sizeexp;
+    }
+
+    if (last) {
+        *last = hash | ((((r_hash) 1) << shift) - 1);
+    }
+    return &buckets[hash >> shift];
+}
+
+static inline int
+ht_is_frozen(
+    struct ht const* ht
+) {
+    return ht->frozen != NULL;
+}
+
+static inline int
+ht_in_bulk(
+    struct ht const* ht
+) {
+    return ht->touched != NULL;
+}
+
+static inline struct flat const*
+ht_flat_for(
+    struct ht const* ht,
+    r_hash hash,
+    r_hash* last
+) {
+    size_t shift = BITCOUNT(hash) - ht->sizeexp;
+
+    if (last) {
+        *last = hash | ((((r_hash) 1) << shift) - 1);
+    }
+    return &ht->frozen[hash >> shift];
+}
+
 #endif //__HT_H__
 
 /**
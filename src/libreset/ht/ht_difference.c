@@ -0,0 +1,208 @@
+#include <errno.h>
+
+#include "ht/ht.h"
+
+/**
+ * Operands of a difference
+ */
+struct difference_operands {
+    struct ht const* a; //!< The first operand
+    struct ht const* b; //!< The second operand
+    struct r_set_cfg const* cfg; //!< type information provided by user
+};
+
+/**
+ * Feed the elements of one hashtable which are not in another one to a function
+ *
+ * The elements within the range [`from`, `to`] are processed. The operands'
+ * buckets are paired by the hash ranges they cover, like in ht_equal(). If
+ * one of the operands is frozen, the elements are looked up one by one.
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+static int
+exclude_range(
+    struct ht const* a,
+    struct ht const* b,
+    r_hash from,
+    r_hash to,
+    struct r_set_cfg const* cfg,
+    avl_emitf emitf,
+    void* etc
+) {
+    if (ht_is_frozen(a) || ht_is_frozen(b)) {
+        return ht_range_foreach_lookup(a, &b, 1, from, to, 0, cfg, emitf, etc);
+    }
+
+    r_hash hash = from;
+    r_hash last_a;
+    r_hash last_b;
+
+    while (1) {
+        struct avl const* avl_a = &ht_bucket_for(a, hash, &last_a)->avl;
+        struct avl const* avl_b = &ht_bucket_for(b, hash, &last_b)->avl;
+        r_hash last = MIN(MIN(last_a, last_b), to);
+
+        int retval = avl_range_exclude(avl_a, avl_b, hash, last, &a->pool,
+                                       &b->pool, cfg, emitf, etc);
+        if (retval || last == to) {
+            return retval;
+        }
+
+        hash = last + 1;
+    }
+}
+
+/**
+ * Produce the elements of a difference within a range of hashes
+ *
+ * This function is a ht_rangef.
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+static int
+difference_range(
+    void* etc,
+    r_hash from,
+    r_hash to,
+    avl_emitf emitf,
+    void* emit_etc
+) {
+    struct difference_operands* ops = (struct difference_operands*) etc;
+    return exclude_range(ops->a, ops->b, from, to, ops->cfg, emitf, emit_etc);
+}
+
+/**
+ * Produce the elements of a symmetric difference within a range of hashes
+ *
+ * This function is a ht_rangef. The elements of each operand which are not in
+ * the other one are produced in a run of their own.
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+static int
+symmetric_difference_range(
+    void* etc,
+    r_hash from,
+    r_hash to,
+    avl_emitf emitf,
+    void* emit_etc
+) {
+    struct difference_operands* ops = (struct difference_operands*) etc;
+
+    int retval = exclude_range(ops->a, ops->b, from, to, ops->cfg, emitf,
+                               emit_etc);
+    if (!retval) {
+        retval = exclude_range(ops->b, ops->a, from, to, ops->cfg, emitf,
+                               emit_etc);
+    }
+    return retval;
+}
+
+/**
+ * Select any element
+ *
+ * This function is a r_predf.
+ *
+ * @return 1
+ */
+static int
+select_all(
+    void const* data,
+    void* etc
+) {
+    return 1;
+}
+
+/**
+ * Compute the symmetric difference of two hashtables in place
+ *
+ * The elements of `other` which are not in `dest` are collected in a temporary
+ * hashtable. Then, the common elements are removed from `dest` and the
+ * collected ones are merged into it.
+ *
+ * @return 0 on success, else a negative error number (errno.h):
+ *         -ENOMEM - on allocation failed
+ */
+static int
+xor_in_place(
+    struct ht* dest,
+    struct ht const* other,
+    struct r_set_cfg const* cfg
+) {
+    if (dest == other) {
+        ht_ndel(dest, select_all, dest, cfg);
+        return 0;
+    }
+
+    // the collected elements are borrowed from `other`, they are only copied
+    // when merged into `dest`
+    struct r_set_cfg tmp_cfg = *cfg;
+    tmp_cfg.copyf = NULL;
+    tmp_cfg.freef = NULL;
+
+    // at least two buckets are needed, or hashes would be shifted too far
+    struct ht tmp;
+    if (!ht_init(&tmp, 1, &tmp_cfg)) {
+        return -ENOMEM;
+    }
+
+    struct difference_operands ops = { .a = other, .b = dest, .cfg = cfg };
+    int retval = ht_merge(&tmp, difference_range, &ops, 0, &tmp_cfg);
+    if (retval >= 0) {
+        ht_ndel_other(dest, other, 1, cfg);
+        retval = ht_union(dest, dest, &tmp, cfg);
+    }
+
+    ht_destroy(&tmp, &tmp_cfg);
+    return retval;
+}
+
+int
+ht_exclude(
+    struct ht* dest,
+    struct ht const* a,
+    struct ht const* b,
+    struct r_set_cfg const* cfg
+) {
+    if (dest == b && dest != a) {
+        return -EINVAL;
+    }
+
+    // remove the elements of `b` in place
+    if (dest == a) {
+        if (a == b) {
+            ht_ndel(dest, select_all, dest, cfg);
+        } else {
+            ht_ndel_other(dest, b, 1, cfg);
+        }
+        return 0;
+    }
+
+    // the difference holds at least the elements of `a` which `b` can't cover
+    size_t n = ht_cardinality(a);
+    n -= MIN(n, ht_cardinality(b));
+
+    struct difference_operands ops = { .a = a, .b = b, .cfg = cfg };
+    return ht_merge(dest, difference_range, &ops, n, cfg);
+}
+
+int
+ht_xor(
+    struct ht* dest,
+    struct ht const* a,
+    struct ht const* b,
+    struct r_set_cfg const* cfg
+) {
+    if (dest == a || dest == b) {
+        return xor_in_place(dest, (dest == a) ? b : a, cfg);
+    }
+
+    // the bigger operand has at least this many elements the other one lacks
+    size_t card_a = ht_cardinality(a);
+    size_t card_b = ht_cardinality(b);
+    size_t n = MAX(card_a, card_b) - MIN(card_a, card_b);
+
+    struct difference_operands ops = { .a = a, .b = b, .cfg = cfg };
+    return ht_merge(dest, symmetric_difference_range, &ops, n, cfg);
+}
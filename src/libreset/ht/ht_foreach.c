@@ -0,0 +1,96 @@
+#include "ht/ht.h"
+
+/**
+ * Lookup of elements in other hashtables, used by ht_range_foreach_lookup()
+ */
+struct lookup {
+    struct ht const* const* others; //!< The hashtables to look elements up in
+    size_t n; //!< The number of hashtables in `others`
+    int common; //!< Whether to pass on the common elements or the others
+    struct r_set_cfg const* cfg; //!< type information provided by user
+    avl_emitf emitf; //!< The function to pass the selected elements on to
+    void* etc; //!< Passed to `emitf`
+};
+
+/**
+ * Pass an element on if it is selected by a lookup
+ *
+ * This function is an avl_emitf, taking a struct lookup as `etc`.
+ *
+ * @return 0 if the element is skipped, else the value returned by `emitf`
+ */
+static int
+emit_by_lookup(
+    void* etc,
+    r_hash hash,
+    void* data
+) {
+    struct lookup* lookup = (struct lookup*) etc;
+
+    size_t i;
+    for (i = 0; i < lookup->n; ++i) {
+        int found = ht_find_hash(lookup->others[i], hash, data,
+                                 lookup->cfg) != NULL;
+        if (found != lookup->common) {
+            return 0;
+        }
+    }
+
+    return lookup->emitf(lookup->etc, hash, data);
+}
+
+int
+ht_range_foreach(
+    struct ht const* ht,
+    r_hash from,
+    r_hash to,
+    avl_emitf emitf,
+    void* etc
+) {
+    r_hash hash = from;
+    r_hash last;
+
+    // the range may span several buckets
+    while (1) {
+        int retval;
+        if (ht_is_frozen(ht)) {
+            struct flat const* flat = ht_flat_for(ht, hash, &last);
+            last = MIN(last, to);
+
+            retval = flat_range_foreach(flat, hash, last, emitf, etc);
+        } else {
+            struct avl const* avl = &ht_bucket_for(ht, hash, &last)->avl;
+            last = MIN(last, to);
+
+            retval = avl_range_foreach(avl, hash, last, &ht->pool, emitf, etc);
+        }
+        if (retval || last == to) {
+            return retval;
+        }
+
+        hash = last + 1;
+    }
+}
+
+int
+ht_range_foreach_lookup(
+    struct ht const* ht,
+    struct ht const* const* others,
+    size_t n,
+    r_hash from,
+    r_hash to,
+    int common,
+    struct r_set_cfg const* cfg,
+    avl_emitf emitf,
+    void* etc
+) {
+    struct lookup lookup = {
+        .others = others,
+        .n = n,
+        .common = common,
+        .cfg = cfg,
+        .emitf = emitf,
+        .etc = etc,
+    };
+    return ht_range_foreach(ht, from, to, emit_by_lookup, &lookup);
+}
@@ -0,0 +1,158 @@
+#include <errno.h>
+
+#include "ht/ht.h"
+#include "ht/common.h"
+#include "common.h"
+
+/**
+ * An element along with its hash
+ */
+struct bulk_entry {
+    r_hash hash; //!< The hash of the element
+    void* data; //!< The element
+};
+
+/**
+ * Elements to insert, sorted by their hashes
+ */
+struct bulk_entries {
+    struct bulk_entry const* entries; //!< The elements
+    size_t n; //!< The number of elements
+    size_t pos; //!< The first element not produced yet
+};
+
+/**
+ * Sort entries by their hashes
+ *
+ * The entries are sorted digit by digit, starting with the least significant
+ * one. The counts for all the digits are collected in a single pass, and the
+ * digits all entries share are skipped. The sorted entries end up either in
+ * `entries` or in `tmp`.
+ *
+ * @return the array holding the sorted entries
+ */
+static struct bulk_entry*
+radix_sort(
+    struct bulk_entry* entries, //!< The entries to sort
+    struct bulk_entry* tmp, //!< Storage for `n` entries
+    size_t n //!< The number of entries
+) {
+    enum {
+        NDIGITS = (BITCOUNT(entries->hash) + HT_RADIX_BITS - 1) / HT_RADIX_BITS
+    };
+    static size_t const radix = CONSTPOW_TWO(HT_RADIX_BITS);
+    size_t counts[NDIGITS][CONSTPOW_TWO(HT_RADIX_BITS)] = { { 0 } };
+
+    size_t i;
+    for (i = 0; i < n; ++i) {
+        size_t d;
+        for (d = 0; d < NDIGITS; ++d) {
+            ++counts[d][(entries[i].hash >> (d * HT_RADIX_BITS)) & (radix - 1)];
+        }
+    }
+
+    size_t d;
+    for (d = 0; d < NDIGITS; ++d) {
+        size_t shift = d * HT_RADIX_BITS;
+
+        // all entries share this digit, the order stays the same
+        if (counts[d][(entries[0].hash >> shift) & (radix - 1)] == n) {
+            continue;
+        }
+
+        // turn the counts into the positions of the first entries
+        size_t pos = 0;
+        size_t k;
+        for (k = 0; k < radix; ++k) {
+            size_t cnt = counts[d][k];
+            counts[d][k] = pos;
+            pos += cnt;
+        }
+
+        for (i = 0; i < n; ++i) {
+            tmp[counts[d][(entries[i].hash >> shift) & (radix - 1)]++] =
+                    entries[i];
+        }
+
+        struct bulk_entry* sorted = tmp;
+        tmp = entries;
+        entries = sorted;
+    }
+
+    return entries;
+}
+
+/**
+ * Produce the sorted elements within a range of hashes
+ *
+ * This function is a ht_rangef, taking a struct bulk_entries as `etc`. Since
+ * the ranges are requested in ascending order, the elements are produced
+ * starting where the previous range ended.
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+static int
+bulk_range(
+    void* etc,
+    r_hash from,
+    r_hash to,
+    avl_emitf emitf,
+    void* emit_etc
+) {
+    struct bulk_entries* bulk = (struct bulk_entries*) etc;
+
+    // restart from the beginning if a range is requested out of order
+    if (bulk->pos && bulk->entries[bulk->pos - 1].hash >= from) {
+        bulk->pos = 0;
+    }
+    while (bulk->pos < bulk->n && bulk->entries[bulk->pos].hash < from) {
+        ++bulk->pos;
+    }
+
+    int retval = 0;
+    while (!retval && bulk->pos < bulk->n &&
+           bulk->entries[bulk->pos].hash <= to) {
+        struct bulk_entry const* entry = &bulk->entries[bulk->pos++];
+        retval = emitf(emit_etc, entry->hash, entry->data);
+    }
+    return retval;
+}
+
+int
+ht_insert_bulk(
+    struct ht* ht,
+    void* const* elems,
+    size_t n,
+    struct r_set_cfg const* cfg
+) {
+    if (n == 0) {
+        return 0;
+    }
+
+    ht_dbg("Inserting %zi elements into %p", n, (void*) ht);
+
+    // the entries and the storage for sorting them are allocated at once
+    size_t size = 2 * n * sizeof(struct bulk_entry);
+    struct bulk_entry* entries = cfg_alloc(cfg, size);
+    if (!entries) {
+        return -ENOMEM;
+    }
+
+    size_t i;
+    for (i = 0; i < n; ++i) {
+        entries[i].hash = cfg->hashf(elems[i]);
+        entries[i].data = elems[i];
+    }
+
+    // in ascending order of their hashes, the elements are in the order of the
+    // buckets, too
+    struct bulk_entries bulk = {
+        .entries = radix_sort(entries, entries + n, n),
+        .n = n,
+        .pos = 0,
+    };
+    int retval = ht_merge(ht, bulk_range, &bulk, n, cfg);
+
+    cfg_dealloc(cfg, entries, size);
+    return retval;
+}
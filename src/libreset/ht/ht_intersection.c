@@ -0,0 +1,286 @@
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "common.h"
+#include "ht/ht.h"
+
+/**
+ * Operands of an intersection
+ */
+struct intersection_operands {
+    struct ht const* a; //!< The operand to take the elements from
+    struct ht const* b; //!< The operand to look the elements up in
+    struct r_set_cfg const* cfg; //!< type information provided by user
+};
+
+/**
+ * Produce the elements of an intersection within a range of hashes
+ *
+ * This function is a ht_rangef. The operands' buckets are paired by the hash
+ * ranges they cover, like in ht_equal(). If one of the operands is frozen, the
+ * elements are looked up one by one.
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+static int
+intersection_range(
+    void* etc,
+    r_hash from,
+    r_hash to,
+    avl_emitf emitf,
+    void* emit_etc
+) {
+    struct intersection_operands* ops = (struct intersection_operands*) etc;
+    if (ht_is_frozen(ops->a) || ht_is_frozen(ops->b)) {
+        return ht_range_foreach_lookup(ops->a, &ops->b, 1, from, to, 1,
+                                       ops->cfg, emitf, emit_etc);
+    }
+
+    r_hash hash = from;
+    r_hash last_a;
+    r_hash last_b;
+
+    while (1) {
+        struct avl const* avl_a = &ht_bucket_for(ops->a, hash, &last_a)->avl;
+        struct avl const* avl_b = &ht_bucket_for(ops->b, hash, &last_b)->avl;
+        r_hash last = MIN(MIN(last_a, last_b), to);
+
+        int retval = avl_range_intersection(avl_a, avl_b, hash, last,
+                                            &ops->a->pool, &ops->b->pool,
+                                            ops->cfg, emitf, emit_etc);
+        if (retval || last == to) {
+            return retval;
+        }
+
+        hash = last + 1;
+    }
+}
+
+/**
+ * Operands of an n-ary intersection
+ */
+struct intersection_n_operands {
+    struct ht const** hts; //!< The operands, ordered by cardinality
+    size_t n; //!< The number of operands
+    struct avl const** avls; //!< The operands' buckets for the current range
+    struct pool const** pools; //!< The operands' pools
+    int lookup; //!< Whether to look the elements up, if an operand is frozen
+    struct r_set_cfg const* cfg; //!< type information provided by user
+};
+
+/**
+ * Produce the elements of an n-ary intersection within a range of hashes
+ *
+ * This function is a ht_rangef. The range is split into parts covered by a
+ * single bucket of each operand. The buckets are intersected all at once. If
+ * an operand is frozen, the elements of the first operand are looked up in
+ * the others one by one instead.
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+static int
+intersection_n_range(
+    void* etc,
+    r_hash from,
+    r_hash to,
+    avl_emitf emitf,
+    void* emit_etc
+) {
+    struct intersection_n_operands* ops =
+            (struct intersection_n_operands*) etc;
+    if (ops->lookup) {
+        return ht_range_foreach_lookup(ops->hts[0], ops->hts + 1, ops->n - 1,
+                                       from, to, 1, ops->cfg, emitf, emit_etc);
+    }
+
+    r_hash hash = from;
+
+    while (1) {
+        r_hash last = to;
+        size_t i;
+        for (i = 0; i < ops->n; ++i) {
+            r_hash last_i;
+            ops->avls[i] = &ht_bucket_for(ops->hts[i], hash, &last_i)->avl;
+            last = MIN(last, last_i);
+        }
+
+        int retval = avl_range_intersection_n(ops->avls, ops->pools, ops->n,
+                                              hash, last, ops->cfg, emitf,
+                                              emit_etc);
+        if (retval || last == to) {
+            return retval;
+        }
+
+        hash = last + 1;
+    }
+}
+
+/**
+ * Compare two hashtables by their cardinality, for qsort()
+ *
+ * @return a negative value, zero or a positive value if the first hashtable
+ *         has fewer, as many or more elements than the second one
+ */
+static int
+cmp_cardinality(
+    void const* a,
+    void const* b
+) {
+    size_t card_a = ht_cardinality(*((struct ht const* const*) a));
+    size_t card_b = ht_cardinality(*((struct ht const* const*) b));
+    return (card_a > card_b) - (card_a < card_b);
+}
+
+/**
+ * Count an element
+ *
+ * This function is an avl_emitf, taking a size_t counter as `etc`.
+ *
+ * @return 0
+ */
+static int
+count_element(
+    void* etc,
+    r_hash hash,
+    void* data
+) {
+    ++*((size_t*) etc);
+    return 0;
+}
+
+/**
+ * Stop at the first element
+ *
+ * This function is an avl_emitf.
+ *
+ * @return 1
+ */
+static int
+stop_at_element(
+    void* etc,
+    r_hash hash,
+    void* data
+) {
+    return 1;
+}
+
+int
+ht_intersection(
+    struct ht* dest,
+    struct ht const* a,
+    struct ht const* b,
+    struct r_set_cfg const* cfg
+) {
+    // remove the elements not in the other operand in place
+    if (dest == a || dest == b) {
+        if (a != b) {
+            ht_ndel_other(dest, (dest == a) ? b : a, 0, cfg);
+        }
+        return 0;
+    }
+
+    // take the elements from the smaller operand
+    struct intersection_operands ops = { .a = a, .b = b, .cfg = cfg };
+    if (ht_cardinality(b) < ht_cardinality(a)) {
+        ops.a = b;
+        ops.b = a;
+    }
+
+    return ht_merge(dest, intersection_range, &ops, 0, cfg);
+}
+
+size_t
+ht_intersection_cardinality(
+    struct ht const* a,
+    struct ht const* b,
+    struct r_set_cfg const* cfg
+) {
+    if (a == b) {
+        return ht_cardinality(a);
+    }
+
+    // take the elements from the smaller operand
+    struct intersection_operands ops = { .a = a, .b = b, .cfg = cfg };
+    if (ht_cardinality(b) < ht_cardinality(a)) {
+        ops.a = b;
+        ops.b = a;
+    }
+
+    size_t card = 0;
+    intersection_range(&ops, 0, SIZE_MAX, count_element, &card);
+    return card;
+}
+
+int
+ht_disjoint(
+    struct ht const* a,
+    struct ht const* b,
+    struct r_set_cfg const* cfg
+) {
+    if (a == b) {
+        return ht_cardinality(a) == 0;
+    }
+
+    // take the elements from the smaller operand
+    struct intersection_operands ops = { .a = a, .b = b, .cfg = cfg };
+    if (ht_cardinality(b) < ht_cardinality(a)) {
+        ops.a = b;
+        ops.b = a;
+    }
+
+    return intersection_range(&ops, 0, SIZE_MAX, stop_at_element, NULL) == 0;
+}
+
+int
+ht_intersection_n(
+    struct ht* dest,
+    struct ht const** hts,
+    size_t n,
+    struct r_set_cfg const* cfg
+) {
+    if (n == 0) {
+        return -EINVAL;
+    }
+
+    // the elements are taken from the smallest operand
+    qsort(hts, n, sizeof(*hts), cmp_cardinality);
+
+    size_t i;
+    for (i = 0; (i < n) && (hts[i] != dest); ++i);
+    if (i < n) {
+        // remove the elements not in the other operands in place
+        for (i = 0; (i < n) && ht_cardinality(dest); ++i) {
+            if (hts[i] != dest) {
+                ht_ndel_other(dest, hts[i], 0, cfg);
+            }
+        }
+        return 0;
+    }
+
+    if (!ht_cardinality(hts[0])) {
+        return 0;
+    }
+
+    struct intersection_n_operands ops = {
+        .hts = hts,
+        .n = n,
+        .avls = cfg_alloc(cfg, n * sizeof(*ops.avls)),
+        .pools = cfg_alloc(cfg, n * sizeof(*ops.pools)),
+        .lookup = 0,
+        .cfg = cfg,
+    };
+
+    int retval = -ENOMEM;
+    if (ops.avls && ops.pools) {
+        for (i = 0; i < n; ++i) {
+            ops.pools[i] = &hts[i]->pool;
+            ops.lookup |= ht_is_frozen(hts[i]);
+        }
+        retval = ht_merge(dest, intersection_n_range, &ops, 0, cfg);
+    }
+
+    cfg_dealloc(cfg, ops.avls, n * sizeof(*ops.avls));
+    cfg_dealloc(cfg, ops.pools, n * sizeof(*ops.pools));
+    return retval;
+}
@@ -0,0 +1,61 @@
+#include <stdint.h>
+
+#include "ht/ht.h"
+
+/**
+ * Stop at the first element
+ *
+ * This function is an avl_emitf.
+ *
+ * @return 1
+ */
+static int
+stop_at_element(
+    void* etc,
+    r_hash hash,
+    void* data
+) {
+    return 1;
+}
+
+int
+ht_is_subset(
+    struct ht const* ht_a,
+    struct ht const* ht_b,
+    struct r_set_cfg const* cfg
+) {
+    // A set with more elements than another is never a subset of it. This
+    // check is cheap, since the cardinality is maintained by the hashtables.
+    if (ht_cardinality(ht_a) > ht_cardinality(ht_b)) {
+        return 0;
+    }
+
+    // Frozen hashtables have no buckets to pair, hence we look each element of
+    // `ht_a` up in `ht_b` and stop at the first one which is missing.
+    if (ht_is_frozen(ht_a) || ht_is_frozen(ht_b)) {
+        return ht_range_foreach_lookup(ht_a, &ht_b, 1, 0, SIZE_MAX, 0, cfg,
+                                       stop_at_element, NULL) == 0;
+    }
+
+    // We verify that each element of `ht_a` is present in `ht_b`, pairing the
+    // buckets by the hash ranges they cover. This way, we don't care whether
+    // the hashtables differ in size or are being resized.
+    r_hash hash = 0;
+    r_hash last_a;
+    r_hash last_b;
+
+    do {
+        struct avl const* avl_a = &ht_bucket_for(ht_a, hash, &last_a)->avl;
+        struct avl const* avl_b = &ht_bucket_for(ht_b, hash, &last_b)->avl;
+        r_hash last = MIN(last_a, last_b);
+
+        if (!avl_range_is_subset(avl_a, avl_b, hash, last, &ht_a->pool,
+                                 &ht_b->pool, cfg)) {
+            return 0;
+        }
+
+        hash = last + 1;
+    } while (hash);
+
+    return 1;
+}
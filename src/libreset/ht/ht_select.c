@@ -8,16 +8,24 @@ ht_select(
     r_procf procf,
     void* dest
 ) {
-    size_t i = ht_nbuckets(src);
+    r_hash hash = 0;
+    r_hash last;
 
-    while (i--) {
-        struct ht_bucket* buck = &src->buckets[i];
-        int retval = avl_select(&buck->avl, pred, pred_etc, procf, dest);
+    do {
+        int retval;
+        if (ht_is_frozen(src)) {
+            struct flat const* flat = ht_flat_for(src, hash, &last);
+            retval = flat_select(flat, pred, pred_etc, procf, dest);
+        } else {
+            struct ht_bucket* buck = ht_bucket_for(src, hash, &last);
+            retval = avl_select(&buck->avl, &src->pool, pred, pred_etc, procf,
+                                dest);
+        }
         if (retval < 0) {
             return retval;
         }
-    }
+        hash = last + 1;
+    } while (hash);
 
     return 0;
 }
-
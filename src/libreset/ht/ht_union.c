@@ -0,0 +1,73 @@
+#include "ht/ht.h"
+
+/**
+ * Operands of a union
+ */
+struct union_operands {
+    struct ht const* const* hts; //!< The operands, which may be NULL
+    size_t n; //!< The number of operands
+};
+
+/**
+ * Produce the elements of a union within a range of hashes
+ *
+ * This function is a ht_rangef. The elements of each operand are produced in
+ * a run of their own. Duplicates are dropped when merging them into the
+ * destination.
+ *
+ * @return 0 on success, else the first non-zero value returned by `emitf`
+ */
+static int
+union_range(
+    void* etc,
+    r_hash from,
+    r_hash to,
+    avl_emitf emitf,
+    void* emit_etc
+) {
+    struct union_operands* ops = (struct union_operands*) etc;
+
+    int retval = 0;
+    size_t i;
+    for (i = 0; !retval && (i < ops->n); ++i) {
+        if (ops->hts[i]) {
+            retval = ht_range_foreach(ops->hts[i], from, to, emitf, emit_etc);
+        }
+    }
+    return retval;
+}
+
+int
+ht_union(
+    struct ht* dest,
+    struct ht const* a,
+    struct ht const* b,
+    struct r_set_cfg const* cfg
+) {
+    struct ht const* hts[] = { a, (b == a) ? NULL : b };
+    return ht_union_n(dest, hts, 2, cfg);
+}
+
+int
+ht_union_n(
+    struct ht* dest,
+    struct ht const** hts,
+    size_t n,
+    struct r_set_cfg const* cfg
+) {
+    // the union holds at least as many elements as the biggest operand
+    size_t card = 0;
+    size_t i;
+    for (i = 0; i < n; ++i) {
+        // the destination already holds the elements of an operand it aliases
+        if (hts[i] == dest) {
+            hts[i] = NULL;
+        }
+        if (hts[i]) {
+            card = MAX(card, ht_cardinality(hts[i]));
+        }
+    }
+
+    struct union_operands ops = { .hts = hts, .n = n };
+    return ht_merge(dest, union_range, &ops, card, cfg);
+}
@@ -36,51 +36,89 @@
  */
 #define ll_dbg(fmt,...) do { dbg("[ll]: "fmt, __VA_ARGS__); } while (0)
 
+/**
+ * Remove the element stored in the head of a linked list
+ *
+ * The data of the element is not freed. If there are further elements, the
+ * first of them is moved into the head.
+ */
+static void
+pop_head(
+    struct ll* ll, //!< The linked list to remove the head from
+    struct pool* pool //!< The pool the elements were allocated from
+) {
+    ll_link link = ll->head.next;
+    if (link) {
+        ll->head = *ll_element_of(link, pool);
+        ll_free_element(pool, link);
+    } else {
+        ll->head.data = NULL;
+    }
+}
+
 void
 ll_destroy(
     struct ll* ll,
+    struct pool* pool,
     struct r_set_cfg const* cfg
 ) {
-    struct ll_element* iter = ll->head;
-    struct ll_element* next;
+    ll_link link = ll->head.next;
     ll_dbg("Destroying: %p", (void*) ll);
 
-    while (iter) {
-        next = iter->next;
+    if (cfg->freef && ll->head.data) {
+        cfg->freef(ll->head.data);
+    }
+
+    while (link) {
+        struct ll_element* iter = ll_element_of(link, pool);
+        ll_link next = iter->next;
         if (cfg->freef) {
             cfg->freef(iter->data);
         }
         ll_dbg("Removing: %p", (void*) iter);
-        free(iter);
-        iter = next;
+        ll_free_element(pool, link);
+        link = next;
     }
+
+    ll->head = (struct ll_element) { .data = NULL };
 }
 
 int
 ll_insert(
     struct ll* ll,
     void* data,
+    struct pool* pool,
     struct r_set_cfg const* cfg
 ) {
-    // check whether the lement is present or not
-    struct ll_element** it = &ll->head;
+    // the first element is stored in the head, without any allocation
+    struct ll_element* el = &ll->head;
+    ll_link* it = &ll->head.next;
 
     ll_dbg("Inserting: %p", (void*) data);
 
-    while (*it) {
-        if (cfg->cmpf((*it)->data, data)) {
+    if (ll->head.data) {
+        // check whether the lement is present or not
+        if (cfg->cmpf(ll->head.data, data)) {
             ll_dbg("already in ll: %p", (void*) data);
             return -EEXIST;
         }
 
-        it = &(*it)->next;
-    }
+        while (*it) {
+            struct ll_element* iter = ll_element_of(*it, pool);
+            if (cfg->cmpf(iter->data, data)) {
+                ll_dbg("already in ll: %p", (void*) data);
+                return -EEXIST;
+            }
 
-    // insert the new element
-    struct ll_element* el = calloc(1, sizeof(struct ll_element));
-    if (!el) {
-        ll_dbg("Inserting into %p aborted (allocation failed)", (void*) ll);
-        return -ENOMEM;
+            it = &iter->next;
+        }
+
+        // insert the new element
+        el = ll_alloc_element(pool, it);
+        if (!el) {
+            ll_dbg("Inserting into %p aborted (allocation failed)", (void*) ll);
+            return -ENOMEM;
+        }
     }
 
     if (cfg->copyf) {
@@ -89,7 +127,17 @@ ll_insert(
         el->data = data;
     }
 
-    *it = el;
+    // an empty head marks an empty list, so we cannot store NULL
+    if (!el->data) {
+        ll_dbg("Inserting into %p aborted (copy failed)", (void*) ll);
+        if (el != &ll->head) {
+            // unlink the new element again
+            ll_link link = *it;
+            *it = el->next;
+            ll_free_element(pool, link);
+        }
+        return -ENOMEM;
+    }
 
     return 0;
 }
@@ -98,15 +146,13 @@ void*
 ll_find(
     struct ll const* ll,
     void const* const d,
+    struct pool const* pool,
     struct r_set_cfg const* cfg
 ) {
-    struct ll_element* iter = ll->head;
-
-    while (iter) {
+    ll_foreach(iter, ll, pool) {
         if (cfg->cmpf(iter->data, d)) {
             return iter->data;
         }
-        iter = iter->next;
     }
 
     return NULL;
@@ -116,29 +162,46 @@ int
 ll_delete(
     struct ll* ll,
     void const* del,
+    struct pool* pool,
     struct r_set_cfg const* cfg
 ) {
-    struct ll_element** iter = &ll->head;
+    ll_link* iter = &ll->head.next;
     ll_dbg("Deleting from %p", (void*) ll);
 
-    // iterate over all the elements
+    if (!ll->head.data) {
+        return -EEXIST;
+    }
+
+    // check whether the element is the one in the head
+    if (cfg->cmpf(ll->head.data, del)) {
+        ll_dbg("Deleting element found in head: %p", (void*) ll);
+        if (cfg->freef) {
+            cfg->freef(ll->head.data);
+        }
+        pop_head(ll, pool);
+        return 0;
+    }
+
+    // iterate over all the other elements
     while (*iter) {
+        struct ll_element* el = ll_element_of(*iter, pool);
+
         // check whther we have found the element to remove
-        if (cfg->cmpf((*iter)->data, del)) {
-            ll_dbg("Deleting element found: %p", (void*) *iter);
-            struct ll_element* to_del = (*iter);
+        if (cfg->cmpf(el->data, del)) {
+            ll_dbg("Deleting element found: %p", (void*) el);
+            ll_link to_del = *iter;
 
             // free, relink and return
             if (cfg->freef) {
-                cfg->freef(to_del->data);
+                cfg->freef(el->data);
             }
-            *iter = to_del->next;
-            free(to_del);
+            *iter = el->next;
+            ll_free_element(pool, to_del);
             return 0;
         }
 
         // iterate further
-        iter = &(*iter)->next;
+        iter = &el->next;
     }
 
     return -EEXIST;
@@ -149,29 +212,45 @@ ll_ndel(
     struct ll* ll,
     r_predf pred,
     void* etc,
+    struct pool* pool,
     struct r_set_cfg const* cfg
 ) {
-    struct ll_element** iter = &ll->head;
+    ll_link* iter = &ll->head.next;
     unsigned int cnt = 0;
 
-    // iterate over all the elements
+    if (!ll->head.data) {
+        return 0;
+    }
+
+    // iterate over all the elements but the head
     while (*iter) {
+        struct ll_element* el = ll_element_of(*iter, pool);
+
         // check whther we have found an element to remove
-        if (!pred((*iter)->data, etc)) {
+        if (!pred(el->data, etc)) {
             // keep this element -> iterate
-            iter = &(*iter)->next;
+            iter = &el->next;
             continue;
         }
 
         // remove this element
-        struct ll_element* to_del = (*iter);
+        ll_link to_del = *iter;
 
         // free, relink and increment the counter
         if (cfg->freef) {
-            cfg->freef(to_del->data);
+            cfg->freef(el->data);
         }
-        *iter = to_del->next;
-        free(to_del);
+        *iter = el->next;
+        ll_free_element(pool, to_del);
+        ++cnt;
+    }
+
+    // the element moved into the head, if any, was already checked
+    if (pred(ll->head.data, etc)) {
+        if (cfg->freef) {
+            cfg->freef(ll->head.data);
+        }
+        pop_head(ll, pool);
         ++cnt;
     }
 
@@ -182,6 +261,5 @@ int
 ll_is_empty(
     struct ll const* ll
 ) {
-    return !ll->head;
+    return !ll->head.data;
 }
-
@@ -34,17 +34,44 @@
 
 #include "libreset/attributes.h"
 #include "libreset/set.h"
+#include "pool.h"
+
+#ifdef INDEX_LINKS
+/**
+ * Link to an element of a linked list
+ *
+ * The elements are referred to by their reference in the pool they were
+ * allocated from. 0 denotes the end of the list.
+ */
+typedef pool_ref ll_link;
+#else
+/**
+ * Link to an element of a linked list
+ *
+ * The elements are referred to by their address. NULL denotes the end of the
+ * list.
+ */
+typedef struct ll_element* ll_link;
+#endif
 
 /**
  * Linked list element type
  *
- * The linked list is a single linked one, so we only hold a pointer to the next
+ * The linked list is a single linked one, so we only hold a link to the next
  * element.
+ *
+ * With `INDEX_LINKS`, the element is packed to 12 bytes, which lets the list
+ * head follow a 32 bit filter in a node of an avl without padding. The data
+ * pointer then is still aligned within the node.
  */
 struct ll_element {
-    struct ll_element*  next; /**< Pointer to next element of linked list */
+    ll_link             next; /**< Link to next element of linked list */
     void*               data; /**< Pointer to the data in this node */
-};
+}
+#ifdef INDEX_LINKS
+__r_packed__ __r_aligned__(sizeof(ll_link))
+#endif
+;
 
 /**
  * Linked list type
@@ -52,9 +79,13 @@ struct ll_element {
  * This type is used as interface to the world.
  * It was introducted for hiding the head pointer of a linked list, so we can
  * modify this one with more ease.
+ *
+ * The first element is stored in the list itself, further elements are only
+ * allocated for additional data. A list whose head holds no data is empty.
+ * Hence, a list can not hold NULL.
  */
 struct ll {
-    struct ll_element* head; /**< Head of the linked list */
+    struct ll_element head; /**< Head of the linked list */
 };
 
 /**
@@ -70,9 +101,10 @@ struct ll {
 void
 ll_destroy(
     struct ll* ll, //!< Ptr to the struct ll object
+    struct pool* pool, //!< The pool the elements were allocated from
     struct r_set_cfg const* cfg //!< type information proveded by the user
 )
-__r_nonnull__(1, 2)
+__r_nonnull__(1, 2, 3)
 ;
 
 /**
@@ -83,16 +115,17 @@ __r_nonnull__(1, 2)
  * @warning the function may crash when being passed NULL for either argument
  *
  * @return 0 if the insertion was successful, error number (errno.h) otherwise
- *         -ENOMEM - on allocation failed
+ *         -ENOMEM - on allocation failed, or if copying the data failed
  *         -EEXIST - if the element is already in the ll
  */
 int
 ll_insert(
     struct ll* ll, /**< Ptr to the linked list object */
     void* data, /**< Ptr to the data to insert */
+    struct pool* pool, //!< The pool to allocate the element from
     struct r_set_cfg const* cfg //!< type information proveded by the user
 )
-__r_nonnull__(1, 2, 3)
+__r_nonnull__(1, 2, 3, 4)
 __r_warn_unused_result__
 ;
 
@@ -107,9 +140,10 @@ void*
 ll_find(
     struct ll const* ll, //!< The linked list to search in
     void const* const d, //!< Data element to compare to
+    struct pool const* pool, //!< The pool the elements were allocated from
     struct r_set_cfg const* cfg //!< Type information provided by the user
 )
-__r_nonnull__(1, 2, 3)
+__r_nonnull__(1, 2, 3, 4)
 __r_warn_unused_result__
 ;
 
@@ -124,9 +158,11 @@ int
 ll_is_subset(
     struct ll const* ll_a, //!< The linked list to search in
     struct ll const* ll_b, //!< The linked list to search in
+    struct pool const* pool_a, //!< The pool of the elements of `ll_a`
+    struct pool const* pool_b, //!< The pool of the elements of `ll_b`
     struct r_set_cfg const* cfg //!< Type information provided by the user
 )
-__r_nonnull__(1, 2, 3)
+__r_nonnull__(1, 2, 3, 4, 5)
 ;
 
 /**
@@ -143,9 +179,10 @@ int
 ll_delete(
     struct ll* ll, //! Ptr to the linked list object
     void const* del, //!< Comparable to object to be removed
+    struct pool* pool, //!< The pool the elements were allocated from
     struct r_set_cfg const* cfg //!< type information proveded by the user
 )
-__r_nonnull__(1, 2, 3)
+__r_nonnull__(1, 2, 3, 4)
 __r_warn_unused_result__
 ;
 
@@ -161,9 +198,10 @@ ll_ndel(
     struct ll* ll, //!< Ptr to the linked list object
     r_predf pred, //!< Predicate for deleting elements
     void* etc, //!< User data for the predicate function
+    struct pool* pool, //!< The pool the elements were allocated from
     struct r_set_cfg const* cfg //!< type information proveded by the user
 )
-__r_nonnull__(1, 4)
+__r_nonnull__(1, 4, 5)
 ;
 
 /**
@@ -190,9 +228,10 @@ __r_warn_unused_result__
  */
 size_t
 ll_count(
-    struct ll const* ll //!< Ptr to the linked list object
+    struct ll const* ll, //!< Ptr to the linked list object
+    struct pool const* pool //!< The pool the elements were allocated from
 )
-__r_nonnull__(1)
+__r_nonnull__(1, 2)
 __r_warn_unused_result__
 ;
 
@@ -201,10 +240,12 @@ __r_warn_unused_result__
  *
  * Helper macro for looping through an linked list.
  * The first parameter should be the name of the iterator,
- * the second parameter is the linked list to iterate through.
+ * the second parameter is the linked list to iterate through,
+ * the third one is the pool its elements were allocated from.
  */
-#define ll_foreach(it,ll) \
-    for (struct ll_element* it = (ll)->head; it; it = it->next)
+#define ll_foreach(it,ll,pool) \
+    for (struct ll_element const* it = (ll)->head.data ? &(ll)->head : NULL; \
+         it; it = ll_next(it, (pool)))
 
 /**
  * Select entries from a linked list into a new one
@@ -216,12 +257,35 @@ __r_warn_unused_result__
 int
 ll_select(
     struct ll const* src, //!< The source from where to select
+    struct pool const* pool, //!< The pool the elements were allocated from
     r_predf pred, //!< The predicate
     void* pred_etc, //!< Additional information for the predicate function
     r_procf procf, //!< function processing the selected values
     void* dest //!< some pointer to pass to the procf
 )
-__r_nonnull__(1, 4)
+__r_nonnull__(1, 2, 5)
+;
+
+/**
+ * Copy a linked list to another pool
+ *
+ * The elements themselves are not copied, both lists refer to the same ones.
+ * The list elements of the copy are allocated one after another, in order.
+ *
+ * @memberof ll
+ *
+ * @return 0 on success, else negative error number (errno.h)
+ *         -ENOMEM - on allocation failed, the elements of the copy allocated so
+ *                   far are left in `dest_pool`
+ */
+int
+ll_copy(
+    struct ll* dest, //!< The linked list to copy to
+    struct ll const* src, //!< The linked list to copy
+    struct pool const* pool, //!< The pool of the elements of `src`
+    struct pool* dest_pool //!< The pool to allocate the elements of `dest` from
+)
+__r_nonnull__(1, 2, 3, 4)
 ;
 
 /**
@@ -235,11 +299,127 @@ int
 ll_equal(
     struct ll const* lla, //!< The first linked list to compare
     struct ll const* llb, //!< The second linked list to compare
+    struct pool const* pool_a, //!< The pool of the elements of `lla`
+    struct pool const* pool_b, //!< The pool of the elements of `llb`
     struct r_set_cfg const* cfg //!< Type information provided by the user
 )
+__r_nonnull__(1, 2, 3, 4)
+;
+
+/**
+ * Get the element a link refers to
+ *
+ * @memberof ll
+ *
+ * @return The element, or NULL if the link denotes the end of the list
+ */
+static inline struct ll_element*
+ll_element_of(
+    ll_link link, //!< The link to resolve
+    struct pool const* pool //!< The pool the element was allocated from
+)
+__r_warn_unused_result__
+;
+
+/**
+ * Get the element following another one
+ *
+ * @memberof ll
+ *
+ * @return The next element, or NULL
+ */
+static inline struct ll_element*
+ll_next(
+    struct ll_element const* el, //!< The element to get the successor of
+    struct pool const* pool //!< The pool the elements were allocated from
+)
+__r_nonnull__(1)
+__r_warn_unused_result__
+;
+
+/**
+ * Allocate a new element of a linked list
+ *
+ * If the allocation fails, `link` is set to denote the end of a list.
+ *
+ * @memberof ll
+ *
+ * @return a pointer to the zero-initialized element, NULL on failure
+ */
+static inline struct ll_element*
+ll_alloc_element(
+    struct pool* pool, //!< The pool to allocate the element from
+    ll_link* link //!< Output for the link to the new element
+)
 __r_nonnull__(1, 2)
+__r_warn_unused_result__
 ;
 
+/**
+ * Release an element of a linked list
+ *
+ * @memberof ll
+ */
+static inline void
+ll_free_element(
+    struct pool* pool, //!< The pool the element was allocated from
+    ll_link link //!< The link to the element
+)
+__r_nonnull__(1)
+;
+
+/*
+ *
+ *
+ * inline implementations
+ *
+ *
+ */
+
+static inline struct ll_element*
+ll_element_of(
+    ll_link link,
+    struct pool const* pool
+) {
+#ifdef INDEX_LINKS
+    return link ? (struct ll_element*) pool_deref(pool, link) : NULL;
+#else
+    return link;
+#endif
+}
+
+static inline struct ll_element*
+ll_next(
+    struct ll_element const* el,
+    struct pool const* pool
+) {
+    return ll_element_of(el->next, pool);
+}
+
+static inline struct ll_element*
+ll_alloc_element(
+    struct pool* pool,
+    ll_link* link
+) {
+#ifdef INDEX_LINKS
+    return pool_alloc_ref(pool, sizeof(struct ll_element), link);
+#else
+    return *link = pool_alloc(pool, sizeof(struct ll_element));
+#endif
+}
+
+static inline void
+ll_free_element(
+    struct pool* pool,
+    ll_link link
+) {
+#ifdef INDEX_LINKS
+    pool_free_ref(pool, link, sizeof(struct ll_element));
+#else
+    pool_free(pool, link, sizeof(struct ll_element));
+#endif
+}
+
 /**
  * @}
  */
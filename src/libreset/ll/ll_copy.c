@@ -0,0 +1,28 @@
+#include <errno.h>
+
+#include "ll/ll.h"
+
+int
+ll_copy(
+    struct ll* dest,
+    struct ll const* src,
+    struct pool const* pool,
+    struct pool* dest_pool
+) {
+    // the first element is stored in the head, without any allocation
+    dest->head = (struct ll_element) { .data = src->head.data };
+
+    ll_link* tail = &dest->head.next;
+    struct ll_element const* it;
+    for (it = ll_next(&src->head, pool); it; it = ll_next(it, pool)) {
+        struct ll_element* el = ll_alloc_element(dest_pool, tail);
+        if (!el) {
+            return -ENOMEM;
+        }
+
+        el->data = it->data;
+        tail = &el->next;
+    }
+
+    return 0;
+}
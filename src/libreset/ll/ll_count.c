@@ -2,17 +2,11 @@
 
 size_t
 ll_count(
-    struct ll const* ll
+    struct ll const* ll,
+    struct pool const* pool
 ) {
-    if(!(ll || ll->head)) {
-        return 0;
-    }
-
-    int size = 0;
-    struct ll_element* iter = ll->head;
-
-    while(iter) {
-        iter = iter->next;
+    size_t size = 0;
+    ll_foreach(iter, ll, pool) {
         size++;
     }
     return size;
@@ -4,6 +4,8 @@ int
 ll_equal(
     struct ll const* lla,
     struct ll const* llb,
+    struct pool const* pool_a,
+    struct pool const* pool_b,
     struct r_set_cfg const* cfg //!< Type information provided by the user
 ) {
     if (lla == llb) {
@@ -14,8 +16,8 @@ ll_equal(
         return 0;
     }
 
-    ll_foreach(it_a, lla) {
-        if (NULL == ll_find(llb, it_a->data, cfg)) {
+    ll_foreach(it_a, lla, pool_a) {
+        if (NULL == ll_find(llb, it_a->data, pool_b, cfg)) {
             return 0;
         }
     }
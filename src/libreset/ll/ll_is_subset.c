@@ -4,14 +4,16 @@ int
 ll_is_subset(
     struct ll const* ll_a,
     struct ll const* ll_b,
+    struct pool const* pool_a,
+    struct pool const* pool_b,
     struct r_set_cfg const* cfg
 ) {
     if (!ll_a) {
         return 1;
     }
 
-    ll_foreach(it, ll_a) {
-        if (!ll_find(ll_b, it->data, cfg)) {
+    ll_foreach(it, ll_a, pool_a) {
+        if (!ll_find(ll_b, it->data, pool_b, cfg)) {
             return 0;
         }
     }
@@ -3,12 +3,13 @@
 int
 ll_select(
     struct ll const* src,
+    struct pool const* pool,
     r_predf pred,
     void* pred_etc,
     r_procf procf,
     void* dest
 ) {
-    ll_foreach(it, src) {
+    ll_foreach(it, src, pool) {
         if (!pred || pred(it->data, pred_etc)) {
             int retval = procf(dest, it->data);
             if (retval < 0) {
@@ -40,6 +40,80 @@
  */
 #define HASH_VARIANTS (3)
 
+/**
+ * Optimal height of the AVL trees making up the buckets of a hash table
+ *
+ * See the paper, section "Resizing the hash table optimally": with bloom
+ * filters of m bits and HASH_VARIANTS variants, a bucket should hold about
+ * m * ln(2) / HASH_VARIANTS elements. For the 56 bits of a filter on 64-bit
+ * targets, these are about 13 elements, which corresponds to an AVL of height
+ * 4. With `INDEX_LINKS`, the 24 bits of a filter call for about 6 elements,
+ * i.e. an AVL of height 3.
+ */
+#ifdef INDEX_LINKS
+#define HT_OPT_HEIGHT (3)
+#else
+#define HT_OPT_HEIGHT (4)
+#endif
+
+/**
+ * Threshold for growing a hash table
+ *
+ * If more than one out of HT_GROW_DENOM buckets holds an AVL higher than
+ * HT_OPT_HEIGHT, the number of buckets is doubled.
+ */
+#define HT_GROW_DENOM (8)
+
+/**
+ * Threshold for shrinking a hash table
+ *
+ * If less than one out of HT_SHRINK_DENOM buckets holds an AVL of at least
+ * HT_OPT_HEIGHT, the number of buckets is halved.
+ * This threshold is far enough from HT_GROW_DENOM for a table not to be shrunk
+ * right after it was grown, and vice versa.
+ */
+#define HT_SHRINK_DENOM (16)
+
+/**
+ * Number of buckets to migrate per modifying hash table operation
+ *
+ * Resizes are performed incrementally: the old buckets are kept alongside the
+ * new ones and each insertion or removal migrates this many of them, which
+ * bounds the latency of a single operation.
+ * If set to 0, all buckets are migrated at once when the resize is triggered.
+ */
+#define HT_MIGRATION_STEP (2)
+
+/**
+ * Number of bits of a hash sorted by per pass when inserting elements in bulk
+ *
+ * The elements are radix sorted by their hashes. Each pass keeps one counter
+ * per possible value of the bits, for which 2^HT_RADIX_BITS entries should
+ * fit into the L1 cache comfortably.
+ */
+#define HT_RADIX_BITS (8)
+
+/**
+ * Size of the first chunk of memory allocated by a pool, in bytes
+ *
+ * Each chunk allocated by a pool is twice the size of the previous one, until
+ * POOL_CHUNK_MAX is reached. Small sets hence stay small, while large ones need
+ * only few allocations.
+ */
+#define POOL_CHUNK_MIN (1024)
+
+/**
+ * Maximum size of a chunk of memory allocated by a pool, in bytes
+ */
+#define POOL_CHUNK_MAX (64 * 1024)
+
+/**
+ * Size of a cache line
+ *
+ * The pools start carving the objects of a chunk at a cache line boundary.
+ */
+#define CACHE_LINE_SIZE (64)
+
 /**
  * @}
  */
@@ -0,0 +1,166 @@
+/*
+ * libreset - Reentrent set library for fast set operations in C
+ *
+ * Copyright (C) 2014 Matthias Beyer
+ * Copyright (C) 2014 Julian Ganz
+ *
+ * This file is part of libreset.
+ *
+ * libreset is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * libreset is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libreset. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+
+#include "pool.h"
+
+#include "params.h"
+#include "util/debug.h"
+#include "util/macros.h"
+
+/**
+ * Debug print helper for pool implementation code
+ *
+ * @note No #ifdef DEBUG here, because if dbg() evaluates to nothing, this code
+ * gets removed by the compiler anyways.
+ */
+#define pool_dbg(fmt,...) do { dbg("[pool]: "fmt, __VA_ARGS__); } while (0)
+
+/**
+ * Get the size of the chunk of a segment
+ *
+ * Each chunk is twice the size of the previous one, until POOL_CHUNK_MAX is
+ * reached.
+ *
+ * @return the size of the chunk in bytes
+ */
+static size_t
+chunk_size(
+    size_t segment //!< The segment of the chunk, starting at 1
+) {
+    size_t size = POOL_CHUNK_MIN;
+    while (--segment && size < POOL_CHUNK_MAX) {
+        size *= 2;
+    }
+    return MIN(size, (size_t) POOL_CHUNK_MAX);
+}
+
+/**
+ * Make room for another chunk in the tables of a pool
+ *
+ * @return 0 on success, -ENOMEM if the allocation failed
+ */
+static int
+grow_tables(
+    struct pool* pool //!< The pool to grow the tables of
+) {
+    size_t capacity = pool->capacity ? pool->capacity * 2 : 8;
+
+    char** chunks = cfg_alloc(pool->cfg, capacity * sizeof(*chunks));
+    if (!chunks) {
+        return -ENOMEM;
+    }
+
+    if (pool->chunks) {
+        memcpy(chunks, pool->chunks, pool->capacity * sizeof(*chunks));
+        cfg_dealloc(pool->cfg, pool->chunks, pool->capacity * sizeof(*chunks));
+    }
+
+    pool->chunks = chunks;
+    pool->capacity = capacity;
+    return 0;
+}
+
+void
+pool_init(
+    struct pool* pool,
+    struct r_set_cfg const* cfg
+) {
+    *pool = (struct pool) { .cfg = cfg };
+}
+
+void
+pool_destroy(
+    struct pool* pool
+) {
+    pool_dbg("Destroying: %p", (void*) pool);
+
+    size_t segment;
+    for (segment = 1; segment <= pool->nchunks; ++segment) {
+        cfg_dealloc(pool->cfg, pool->chunks[segment], chunk_size(segment));
+    }
+
+    if (pool->chunks) {
+        cfg_dealloc(pool->cfg, pool->chunks,
+                    pool->capacity * sizeof(*pool->chunks));
+    }
+    pool_init(pool, pool->cfg);
+}
+
+void*
+pool_refill(
+    struct pool* pool,
+    size_t size
+) {
+    size_t segment = pool->nchunks + 1;
+#ifdef INDEX_LINKS
+    if (segment > POOL_MAX_CHUNKS) {
+        pool_dbg("Refilling %p aborted (references exhausted)", (void*) pool);
+        return NULL;
+    }
+#endif
+
+    // segments start at 1, the first entry of the table is not used
+    if (segment >= pool->capacity && grow_tables(pool) < 0) {
+        pool_dbg("Refilling %p aborted (allocation failed)", (void*) pool);
+        return NULL;
+    }
+
+    char* chunk = cfg_alloc(pool->cfg, chunk_size(segment));
+    if (!chunk) {
+        pool_dbg("Refilling %p aborted (allocation failed)", (void*) pool);
+        return NULL;
+    }
+    pool_dbg("Allocated chunk %p of %zu bytes for %p", (void*) chunk,
+             chunk_size(segment), (void*) pool);
+
+    // keep the remainder of the current chunk for later allocations
+    size_t class = POOL_CLASSES;
+    while (class--) {
+        size_t slot_size = (class + 1) * POOL_GRANULE;
+        while ((size_t) (pool->end - pool->next) >= slot_size) {
+#ifdef INDEX_LINKS
+            // most objects are allocated along with their reference
+            struct pool_ref_slot* slot = (struct pool_ref_slot*) pool->next;
+            slot->next = pool->free_refs[class];
+            pool->free_refs[class] = pool_current_ref(pool, slot);
+#else
+            struct pool_slot* slot = (struct pool_slot*) pool->next;
+            slot->next = pool->free[class];
+            pool->free[class] = slot;
+#endif
+            pool->next += slot_size;
+        }
+    }
+
+    pool->chunks[segment] = chunk;
+    pool->nchunks = segment;
+
+    // carve from a cache line boundary, so a run of 32 byte nodes never
+    // straddles two lines
+    char* start = chunk + (-(uintptr_t) chunk % CACHE_LINE_SIZE);
+    pool->next = start + size;
+    pool->end = chunk + chunk_size(segment);
+    return start;
+}
@@ -0,0 +1,382 @@
+/*
+ * libreset - Reentrent set library for fast set operations in C
+ *
+ * Copyright (C) 2014 Matthias Beyer
+ * Copyright (C) 2014 Julian Ganz
+ *
+ * This file is part of libreset.
+ *
+ * libreset is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * libreset is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with libreset. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup internal_pool_interface
+ *
+ * This group contains the interface definition for the pool allocator used for
+ * the nodes of the data structures.
+ *
+ * @{
+ */
+
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "libreset/attributes.h"
+#include "libreset/set.h"
+#include "common.h"
+#include "params.h"
+#include "util/likely.h"
+
+/**
+ * Type with the strictest alignment required by the objects of a pool
+ *
+ * The nodes and list elements only consist of pointers and pointer sized
+ * integers. They hence do not need the alignment of `max_align_t`, which would
+ * round e.g. a node of 56 bytes up to 64 bytes.
+ */
+union pool_align {
+    void* ptr;
+    size_t size;
+};
+
+/**
+ * Granularity of the objects served by a pool, in bytes
+ *
+ * Object sizes are rounded up to a multiple of this value, which also is the
+ * alignment of the objects.
+ */
+#define POOL_GRANULE (_Alignof(union pool_align))
+
+/**
+ * Number of size classes served by a pool
+ *
+ * A pool serves objects of up to `POOL_CLASSES * POOL_GRANULE` bytes, which is
+ * 64 bytes. Larger objects are allocated individually, using the allocation
+ * functions of the pool's configuration.
+ */
+#define POOL_CLASSES (64 / POOL_GRANULE)
+
+/**
+ * Number of granules addressed by one segment of a pool
+ *
+ * Each chunk of a pool is assigned a segment of this size in the space of
+ * object references. A segment covers the largest chunk a pool may allocate.
+ */
+#define POOL_SEGMENT (POOL_CHUNK_MAX / POOL_GRANULE)
+
+/**
+ * Reference to an object of a pool
+ *
+ * A reference is the index of the object's first granule within the segments
+ * of the pool. It is valid only in the pool the object was allocated from, and
+ * it is never 0.
+ */
+typedef uint32_t pool_ref;
+
+/**
+ * Maximum number of chunks a pool allocates, if its objects are referenced
+ *
+ * The references of the objects in further chunks would overflow.
+ */
+#define POOL_MAX_CHUNKS ((size_t) UINT32_MAX / POOL_SEGMENT)
+
+/**
+ * Object freed to a pool
+ */
+struct pool_slot {
+    struct pool_slot* next; //!< The next free object of the same size class
+};
+
+#ifdef INDEX_LINKS
+/**
+ * Referenced object freed to a pool
+ */
+struct pool_ref_slot {
+    pool_ref next; //!< The next free object of the same size class, or 0
+};
+#endif
+
+/**
+ * Pool allocator type
+ *
+ * A pool serves small objects of fixed sizes, e.g. the nodes of an avl. Memory
+ * is allocated in chunks, from which objects are carved by bumping a pointer.
+ * Hence, objects allocated one after another are placed next to each other.
+ * Objects released to the pool are kept in one free list per size class and
+ * are reused by subsequent allocations of the same size. The chunks are only
+ * released when the pool is destroyed.
+ *
+ * A pool is not shared between sets. All objects of a pool must be released to
+ * that pool. The chunks are allocated via the allocation functions of the
+ * configuration the pool was initialized with.
+ *
+ * With `INDEX_LINKS`, objects may also be allocated along with their reference
+ * via pool_alloc_ref(). Those are released via pool_free_ref(), to free lists
+ * linked by reference.
+ */
+struct pool {
+    char* next; //!< The next unused byte of the current chunk
+    char* end; //!< The end of the current chunk
+    struct pool_slot* free[POOL_CLASSES]; //!< Freed objects, per size class
+#ifdef INDEX_LINKS
+    pool_ref free_refs[POOL_CLASSES]; //!< Freed referenced objects, per class
+#endif
+    char** chunks; //!< The chunks allocated, by segment, starting at 1
+    size_t nchunks; //!< The number of chunks allocated
+    size_t capacity; //!< The number of entries allocated for `chunks`
+    struct r_set_cfg const* cfg; //!< type information provided by the user
+};
+
+/**
+ * Initialize a pool
+ *
+ * @memberof pool
+ */
+void
+pool_init(
+    struct pool* pool, //!< The pool to initialize
+    struct r_set_cfg const* cfg //!< type information provided by the user
+)
+__r_nonnull__(1, 2)
+;
+
+/**
+ * Destroy a pool
+ *
+ * All memory allocated by the pool is released, including the objects which
+ * are still in use.
+ *
+ * @memberof pool
+ */
+void
+pool_destroy(
+    struct pool* pool //!< The pool to destroy
+)
+__r_nonnull__(1)
+;
+
+/**
+ * Carve an object from a new chunk
+ *
+ * @memberof pool
+ *
+ * @warning for use by pool_alloc() only
+ *
+ * @return a pointer to the uninitialized object, NULL on failure
+ */
+void*
+pool_refill(
+    struct pool* pool, //!< The pool to allocate a new chunk for
+    size_t size //!< The size of the object, rounded to POOL_GRANULE
+)
+__r_nonnull__(1)
+__r_warn_unused_result__
+;
+
+/**
+ * Get the object a reference refers to
+ *
+ * @memberof pool
+ *
+ * @return a pointer to the object
+ */
+static inline void*
+pool_deref(
+    struct pool const* pool, //!< The pool the object was allocated from
+    pool_ref ref //!< A reference obtained from the pool
+) {
+    return pool->chunks[ref / POOL_SEGMENT] +
+        (size_t) (ref % POOL_SEGMENT) * POOL_GRANULE;
+}
+
+/**
+ * Get the size class of an object
+ *
+ * @memberof pool
+ *
+ * @return the index of the size class, POOL_CLASSES or greater for objects too
+ *         large for the pool
+ */
+static inline size_t
+pool_class(
+    size_t size //!< The size of the object
+) {
+    return (size - 1) / POOL_GRANULE;
+}
+
+/**
+ * Carve an object from the current chunk of a pool
+ *
+ * A new chunk is allocated if the current one is exhausted.
+ *
+ * @memberof pool
+ *
+ * @return a pointer to the uninitialized object, NULL on failure
+ */
+static inline void*
+pool_carve(
+    struct pool* pool, //!< The pool to allocate from
+    size_t class //!< The size class of the object
+) {
+    size_t size = (class + 1) * POOL_GRANULE;
+    if (likely((size_t) (pool->end - pool->next) >= size)) {
+        void* obj = pool->next;
+        pool->next += size;
+        return obj;
+    }
+    return pool_refill(pool, size);
+}
+
+#ifdef INDEX_LINKS
+/**
+ * Get the reference of a location within the current chunk of a pool
+ *
+ * @memberof pool
+ *
+ * @return the reference of the location
+ */
+static inline pool_ref
+pool_current_ref(
+    struct pool const* pool, //!< The pool
+    void const* obj //!< A location within the current chunk
+) {
+    size_t offset = (size_t) ((char const*) obj - pool->chunks[pool->nchunks]);
+    return (pool_ref) (pool->nchunks * POOL_SEGMENT + offset / POOL_GRANULE);
+}
+
+/**
+ * Allocate an object from a pool, along with its reference
+ *
+ * The object is taken from the free list of referenced objects of its size
+ * class, or carved from the current chunk if the list is empty.
+ *
+ * @memberof pool
+ *
+ * @warning `size` must not exceed the largest size class of the pool
+ *
+ * @return a pointer to the zero-initialized object, NULL on failure, in which
+ *         case `ref` is set to 0
+ */
+static inline void*
+pool_alloc_ref(
+    struct pool* pool, //!< The pool to allocate from
+    size_t size, //!< The size of the object
+    pool_ref* ref //!< Output for the reference of the object
+) {
+    size_t class = pool_class(size);
+
+    void* obj;
+    *ref = pool->free_refs[class];
+    if (*ref) {
+        obj = pool_deref(pool, *ref);
+        pool->free_refs[class] = ((struct pool_ref_slot*) obj)->next;
+    } else {
+        obj = pool_carve(pool, class);
+        if (!obj) {
+            return NULL;
+        }
+        *ref = pool_current_ref(pool, obj);
+    }
+
+    return memset(obj, 0, size);
+}
+
+/**
+ * Release an object allocated via pool_alloc_ref() to a pool
+ *
+ * @memberof pool
+ *
+ * @warning `size` must be the size the object was allocated with
+ */
+static inline void
+pool_free_ref(
+    struct pool* pool, //!< The pool the object was allocated from
+    pool_ref ref, //!< The reference of the object to release
+    size_t size //!< The size of the object
+) {
+    size_t class = pool_class(size);
+
+    struct pool_ref_slot* slot = (struct pool_ref_slot*) pool_deref(pool, ref);
+    slot->next = pool->free_refs[class];
+    pool->free_refs[class] = ref;
+}
+#endif
+
+/**
+ * Allocate an object from a pool
+ *
+ * The object is taken from the free list of its size class, or carved from the
+ * current chunk if the list is empty.
+ *
+ * @memberof pool
+ *
+ * @return a pointer to the zero-initialized object, NULL on failure
+ */
+static inline void*
+pool_alloc(
+    struct pool* pool, //!< The pool to allocate from
+    size_t size //!< The size of the object
+) {
+    size_t class = pool_class(size);
+    if (unlikely(class >= POOL_CLASSES)) {
+        return cfg_alloc(pool->cfg, size);
+    }
+
+    void* obj = pool->free[class];
+    if (obj) {
+        pool->free[class] = pool->free[class]->next;
+    } else {
+        obj = pool_carve(pool, class);
+        if (!obj) {
+            return NULL;
+        }
+    }
+
+    return memset(obj, 0, size);
+}
+
+/**
+ * Release an object to a pool
+ *
+ * @memberof pool
+ *
+ * @warning `size` must be the size the object was allocated with
+ */
+static inline void
+pool_free(
+    struct pool* pool, //!< The pool the object was allocated from
+    void* obj, //!< The object to release
+    size_t size //!< The size of the object
+) {
+    size_t class = pool_class(size);
+    if (unlikely(class >= POOL_CLASSES)) {
+        cfg_dealloc(pool->cfg, obj, size);
+        return;
+    }
+
+    struct pool_slot* slot = (struct pool_slot*) obj;
+    slot->next = pool->free[class];
+    pool->free[class] = slot;
+}
+
+#endif //__POOL_H__
+
+/**
+ * @}
+ */
@@ -36,23 +36,75 @@ struct r_set {
     const struct r_set_cfg* cfg;
 };
 
+/**
+ * Check whether a set may be modified other than by single insertions and
+ * removals
+ *
+ * @return 0 if the set may be modified, else error code:
+ *         -EPERM - if the set is frozen
+ *         -EBUSY - if a bulk session is in progress on the set
+ */
+static int
+check_modifiable(
+    struct r_set const* set //!< The set to check
+) {
+    if (ht_is_frozen(&set->ht)) {
+        return -EPERM;
+    }
+    if (ht_in_bulk(&set->ht)) {
+        return -EBUSY;
+    }
+    return 0;
+}
+
+/**
+ * Collect the hashtables of an array of sets
+ *
+ * @return 0 on success, else error code:
+ *         -EINVAL - if the configuration of a set differs from `dest`'s
+ */
+static int
+collect_hts(
+    struct ht const** hts, //!< Output for the hashtables
+    struct r_set const* dest, //!< The set to compare the configurations with
+    struct r_set const* const* sets, //!< The sets
+    size_t n //!< The number of sets
+) {
+    size_t i;
+    for (i = 0; i < n; ++i) {
+        if (!config_cmp(dest->cfg, sets[i]->cfg)) {
+            return -EINVAL;
+        }
+        hts[i] = &sets[i]->ht;
+    }
+    return 0;
+}
+
 struct r_set*
 r_set_new(
     struct r_set_cfg const* cfg
 ) {
-    set_dbg("Allocate set with config %p", (void*) cfg);
+    return r_set_new_with_capacity(cfg, 0);
+}
+
+struct r_set*
+r_set_new_with_capacity(
+    struct r_set_cfg const* cfg,
+    size_t n
+) {
+    set_dbg("Allocate set with config %p for %zi elements", (void*) cfg, n);
     /*
-     * magic constant: We initialize the hashtable with 8 buckets, 2^3 == 8, so
-     * we must set `ht_init_power` to 3
+     * magic constant: We initialize the hashtable with at least 8 buckets,
+     * 2^3 == 8, so `ht_init_power` must be at least 3
      */
-    const size_t ht_init_power = 3;
+    const size_t ht_init_power = MAX((size_t) 3, ht_sizeexp_for(n));
 
-    struct r_set* set = calloc(1, sizeof(*set));
+    struct r_set* set = cfg_alloc(cfg, sizeof(*set));
 
     if (likely(set)) {
-        if (!ht_init(&set->ht, ht_init_power)) {
+        if (!ht_init(&set->ht, ht_init_power, cfg)) {
             set_dbg("Allocation failed: %p", (void*)set);
-            free(set);
+            cfg_dealloc(cfg, set, sizeof(*set));
             set = NULL;
         } else {
             set->cfg = cfg;
@@ -62,6 +114,91 @@ r_set_new(
     return set;
 }
 
+struct r_set*
+r_set_from_array(
+    struct r_set_cfg const* cfg,
+    void* const* elems,
+    size_t n
+) {
+    struct r_set* set = r_set_new_with_capacity(cfg, n);
+    if (set && ht_insert_bulk(&set->ht, elems, n, cfg) < 0) {
+        set_dbg("Allocation failed: %p", (void*) set);
+
+        // the elements stay owned by the caller, unless the set holds copies
+        struct r_set_cfg tmp_cfg = *cfg;
+        if (!cfg->copyf) {
+            tmp_cfg.freef = NULL;
+        }
+        ht_destroy(&set->ht, &tmp_cfg);
+        cfg_dealloc(cfg, set, sizeof(*set));
+        set = NULL;
+    }
+
+    return set;
+}
+
+int
+r_set_reserve(
+    struct r_set* set,
+    size_t n
+) {
+    set_dbg("Reserve capacity for %zi elements in set %p", n, (void*) set);
+
+    int retval = check_modifiable(set);
+    if (retval < 0) {
+        return retval;
+    }
+
+    return ht_reserve(&set->ht, n);
+}
+
+int
+r_set_freeze(
+    struct r_set* set
+) {
+    set_dbg("Freeze set %p", (void*) set);
+
+    if (ht_in_bulk(&set->ht)) {
+        return -EBUSY;
+    }
+
+    return ht_freeze(&set->ht, set->cfg);
+}
+
+int
+r_set_compact(
+    struct r_set* set
+) {
+    set_dbg("Compact set %p", (void*) set);
+
+    if (ht_in_bulk(&set->ht)) {
+        return -EBUSY;
+    }
+
+    return ht_compact(&set->ht, set->cfg);
+}
+
+int
+r_set_begin_bulk(
+    struct r_set* set
+) {
+    set_dbg("Begin bulk session on set %p", (void*) set);
+
+    if (ht_is_frozen(&set->ht)) {
+        return -EPERM;
+    }
+
+    return ht_begin_bulk(&set->ht, set->cfg);
+}
+
+void
+r_set_end_bulk(
+    struct r_set* set
+) {
+    set_dbg("End bulk session on set %p", (void*) set);
+    ht_end_bulk(&set->ht, set->cfg);
+}
+
 int
 r_set_destroy(
     struct r_set* set
@@ -69,8 +206,9 @@ r_set_destroy(
     int ret;
     if (set) {
         set_dbg("Destroy set: %p", (void*) set);
-        ret = ht_destroy(&set->ht, set->cfg);
-        free(set);
+        struct r_set_cfg const* cfg = set->cfg;
+        ret = ht_destroy(&set->ht, cfg);
+        cfg_dealloc(cfg, set, sizeof(*set));
     } else {
         return -EEXIST;
     }
@@ -83,9 +221,30 @@ r_set_insert(
     void* value
 ) {
     set_dbg("Insert %p into set %p", (void*) value, (void*) set);
+
+    if (ht_is_frozen(&set->ht)) {
+        return -EPERM;
+    }
+
     return ht_insert(&set->ht, value, set->cfg);
 }
 
+int
+r_set_insert_bulk(
+    struct r_set* set,
+    void* const* elems,
+    size_t n
+) {
+    set_dbg("Insert %zi elements into set %p", n, (void*) set);
+
+    int retval = check_modifiable(set);
+    if (retval < 0) {
+        return retval;
+    }
+
+    return ht_insert_bulk(&set->ht, elems, n, set->cfg);
+}
+
 int
 r_set_remove(
     struct r_set* set,
@@ -93,6 +252,11 @@ r_set_remove(
 ) {
     set_dbg("Remove with compare element %p from set %p",
             (void*) cmp, (void*) set);
+
+    if (ht_is_frozen(&set->ht)) {
+        return -EPERM;
+    }
+
     return ht_del(&set->ht, cmp, set->cfg);
 }
 
@@ -126,6 +290,224 @@ r_set_select(
     return ht_select(&src->ht, pred, pred_etc, procf, dest);
 }
 
+int
+r_set_union(
+    struct r_set* dest,
+    struct r_set const* set_a,
+    struct r_set const* set_b
+) {
+    set_dbg("Union of sets %p and %p into %p",
+            (void*) set_a, (void*) set_b, (void*) dest);
+
+    if (!config_cmp(dest->cfg, set_a->cfg) ||
+            !config_cmp(dest->cfg, set_b->cfg)) {
+        return -EINVAL;
+    }
+
+    int retval = check_modifiable(dest);
+    if (retval < 0) {
+        return retval;
+    }
+
+    return ht_union(&dest->ht, &set_a->ht, &set_b->ht, dest->cfg);
+}
+
+int
+r_set_intersection(
+    struct r_set* dest,
+    struct r_set const* set_a,
+    struct r_set const* set_b
+) {
+    set_dbg("Intersection of sets %p and %p into %p",
+            (void*) set_a, (void*) set_b, (void*) dest);
+
+    if (!config_cmp(dest->cfg, set_a->cfg) ||
+            !config_cmp(dest->cfg, set_b->cfg)) {
+        return -EINVAL;
+    }
+
+    int retval = check_modifiable(dest);
+    if (retval < 0) {
+        return retval;
+    }
+
+    return ht_intersection(&dest->ht, &set_a->ht, &set_b->ht, dest->cfg);
+}
+
+int
+r_set_union_n(
+    struct r_set* dest,
+    struct r_set const* const* sets,
+    size_t n
+) {
+    set_dbg("Union of %zi sets into %p", n, (void*) dest);
+
+    int retval = check_modifiable(dest);
+    if (retval < 0) {
+        return retval;
+    }
+
+    struct ht const** hts = cfg_alloc(dest->cfg, n * sizeof(*hts));
+    if (n && !hts) {
+        return -ENOMEM;
+    }
+
+    retval = collect_hts(hts, dest, sets, n);
+    if (retval == 0) {
+        retval = ht_union_n(&dest->ht, hts, n, dest->cfg);
+    }
+
+    cfg_dealloc(dest->cfg, hts, n * sizeof(*hts));
+    return retval;
+}
+
+int
+r_set_intersection_n(
+    struct r_set* dest,
+    struct r_set const* const* sets,
+    size_t n
+) {
+    set_dbg("Intersection of %zi sets into %p", n, (void*) dest);
+
+    int retval = check_modifiable(dest);
+    if (retval < 0) {
+        return retval;
+    }
+
+    struct ht const** hts = cfg_alloc(dest->cfg, n * sizeof(*hts));
+    if (n && !hts) {
+        return -ENOMEM;
+    }
+
+    retval = collect_hts(hts, dest, sets, n);
+    if (retval == 0) {
+        retval = ht_intersection_n(&dest->ht, hts, n, dest->cfg);
+    }
+
+    cfg_dealloc(dest->cfg, hts, n * sizeof(*hts));
+    return retval;
+}
+
+int
+r_set_xor(
+    struct r_set* dest,
+    struct r_set const* set_a,
+    struct r_set const* set_b
+) {
+    set_dbg("Symmetric difference of sets %p and %p into %p",
+            (void*) set_a, (void*) set_b, (void*) dest);
+
+    if (!config_cmp(dest->cfg, set_a->cfg) ||
+            !config_cmp(dest->cfg, set_b->cfg)) {
+        return -EINVAL;
+    }
+
+    int retval = check_modifiable(dest);
+    if (retval < 0) {
+        return retval;
+    }
+
+    return ht_xor(&dest->ht, &set_a->ht, &set_b->ht, dest->cfg);
+}
+
+int
+r_set_exclude(
+    struct r_set* dest,
+    struct r_set const* set_a,
+    struct r_set const* set_b
+) {
+    set_dbg("Exclude elements of set %p from set %p into %p",
+            (void*) set_b, (void*) set_a, (void*) dest);
+
+    if (!config_cmp(dest->cfg, set_a->cfg) ||
+            !config_cmp(dest->cfg, set_b->cfg)) {
+        return -EINVAL;
+    }
+
+    int retval = check_modifiable(dest);
+    if (retval < 0) {
+        return retval;
+    }
+
+    return ht_exclude(&dest->ht, &set_a->ht, &set_b->ht, dest->cfg);
+}
+
+size_t
+r_set_union_cardinality(
+    struct r_set const* set_a,
+    struct r_set const* set_b
+) {
+    return r_set_cardinality(set_a) + r_set_cardinality(set_b) -
+            r_set_intersection_cardinality(set_a, set_b);
+}
+
+size_t
+r_set_intersection_cardinality(
+    struct r_set const* set_a,
+    struct r_set const* set_b
+) {
+    set_dbg("Count common elements of sets %p and %p",
+            (void*) set_a, (void*) set_b);
+
+    if (!config_cmp(set_a->cfg, set_b->cfg)) {
+        return 0;
+    }
+
+    return ht_intersection_cardinality(&set_a->ht, &set_b->ht, set_a->cfg);
+}
+
+size_t
+r_set_xor_cardinality(
+    struct r_set const* set_a,
+    struct r_set const* set_b
+) {
+    return r_set_cardinality(set_a) + r_set_cardinality(set_b) -
+            2 * r_set_intersection_cardinality(set_a, set_b);
+}
+
+size_t
+r_set_exclude_cardinality(
+    struct r_set const* set_a,
+    struct r_set const* set_b
+) {
+    return r_set_cardinality(set_a) -
+            r_set_intersection_cardinality(set_a, set_b);
+}
+
+int
+r_set_is_subset(
+    struct r_set const* set_a,
+    struct r_set const* set_b
+) {
+    set_dbg("Check whether set %p is a subset of %p",
+            (void*) set_a, (void*) set_b);
+
+    if (set_a == set_b) {
+        return 1;
+    }
+
+    if (!config_cmp(set_a->cfg, set_b->cfg)) {
+        return 0;
+    }
+
+    return ht_is_subset(&set_a->ht, &set_b->ht, set_a->cfg);
+}
+
+int
+r_set_disjoint(
+    struct r_set const* set_a,
+    struct r_set const* set_b
+) {
+    set_dbg("Check whether sets %p and %p are disjoint",
+            (void*) set_a, (void*) set_b);
+
+    if (!config_cmp(set_a->cfg, set_b->cfg)) {
+        return 1;
+    }
+
+    return ht_disjoint(&set_a->ht, &set_b->ht, set_a->cfg);
+}
+
 int
 r_set_equal(
     struct r_set const* set_a,
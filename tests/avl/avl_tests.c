@@ -10,9 +10,10 @@ START_TEST (test_avl_alloc_destroy) {
     struct avl* avl = calloc(1, sizeof(*avl));
 
     ck_assert(avl != NULL);
-    ck_assert(avl->root == NULL);
+    ck_assert(avl_root(avl, &pool) == NULL);
 
-    ck_assert(-EEXIST == avl_destroy(avl, &cfg_int)); // root node is NULL
+    // root node is NULL
+    ck_assert(-EEXIST == avl_destroy(avl, &pool, &cfg_int));
 }
 END_TEST
 
@@ -22,11 +23,11 @@ START_TEST (test_avl_insert) {
     int data = 1;
     r_hash hash = 1;
 
-    avl_insert(avl, hash, &data, &cfg_int);
+    avl_insert(avl, hash, &data, &pool, &cfg_int);
 
-    ck_assert(&data == avl_find(avl, hash, &data, &cfg_int));
+    ck_assert(&data == avl_find(avl, hash, &data, &pool, &cfg_int));
 
-    avl_destroy(avl, &cfg_int);
+    avl_destroy(avl, &pool, &cfg_int);
 }
 END_TEST
 
@@ -36,9 +37,9 @@ START_TEST (test_avl_insert_destroy) {
     int data = 1;
     r_hash hash = 1;
 
-    avl_insert(avl, hash, &data, &cfg_int);
+    avl_insert(avl, hash, &data, &pool, &cfg_int);
 
-    ck_assert(0 == avl_destroy(avl, &cfg_int));
+    ck_assert(0 == avl_destroy(avl, &pool, &cfg_int));
 }
 END_TEST
 
@@ -51,15 +52,16 @@ START_TEST (test_avl_insert_multiple) {
 
     int i;
     for (i = 0; i < 10; i++) {
-        ck_assert(0 == avl_insert(avl, hash[i], &data[i], &cfg_int));
+        ck_assert(0 == avl_insert(avl, hash[i], &data[i], &pool, &cfg_int));
     }
-    ck_assert(avl_node_cnt(avl->root) == 10);
+    ck_assert(avl_node_cnt(avl_root(avl, &pool), &pool) == 10);
 
     for (i = 0; i < 10; i++) {
-        ck_assert(&data[i] == avl_find(avl, hash[i], &data[i], &cfg_int));
+        ck_assert(&data[i] ==
+                  avl_find(avl, hash[i], &data[i], &pool, &cfg_int));
     }
 
-    avl_destroy(avl, &cfg_int);
+    avl_destroy(avl, &pool, &cfg_int);
 }
 END_TEST
 
@@ -73,14 +75,15 @@ START_TEST (test_avl_insert_many_distinct) {
     int i;
     for (i = 0; i < MANY_INTS_CNT; i++) {
         data[i] = i;
-        ck_assert(0 == avl_insert(avl, data[i], &data[i], &cfg_int));
+        ck_assert(0 == avl_insert(avl, data[i], &data[i], &pool, &cfg_int));
     }
 
     for (i = 0; i < MANY_INTS_CNT; i++) {
-        ck_assert(&data[i] == avl_find(avl, data[i], &data[i], &cfg_int));
+        ck_assert(&data[i] ==
+                  avl_find(avl, data[i], &data[i], &pool, &cfg_int));
     }
 
-    ck_assert(0 == avl_destroy(avl, &cfg_int));
+    ck_assert(0 == avl_destroy(avl, &pool, &cfg_int));
 }
 END_TEST
 
@@ -92,10 +95,10 @@ START_TEST (test_avl_insert_multiple_destroy) {
 
     int i;
     for (i = 0; i < 10; i++) {
-        avl_insert(avl, hash[i], &data[i], &cfg_int);
+        avl_insert(avl, hash[i], &data[i], &pool, &cfg_int);
     }
 
-    ck_assert(0 == avl_destroy(avl, &cfg_int));
+    ck_assert(0 == avl_destroy(avl, &pool, &cfg_int));
 }
 END_TEST
 
@@ -107,14 +110,14 @@ START_TEST (test_avl_insert_collisions) {
 
     int i;
     for (i = 0; i < 10; i++) {
-        ck_assert(0 == avl_insert(avl, hash, &data[i], &cfg_int));
+        ck_assert(0 == avl_insert(avl, hash, &data[i], &pool, &cfg_int));
     }
 
     for (i = 0; i < 10; i++) {
-        ck_assert(&data[i] == avl_find(avl, hash, &data[i], &cfg_int));
+        ck_assert(&data[i] == avl_find(avl, hash, &data[i], &pool, &cfg_int));
     }
 
-    ck_assert(0 == avl_destroy(avl, &cfg_int));
+    ck_assert(0 == avl_destroy(avl, &pool, &cfg_int));
 }
 END_TEST
 
@@ -124,13 +127,13 @@ START_TEST (test_avl_delete) {
     int data = 1;
     r_hash hash = 1;
 
-    avl_insert(avl, hash, &data, &cfg_int);
+    avl_insert(avl, hash, &data, &pool, &cfg_int);
 
-    ck_assert(&data == avl_find(avl, hash, &data, &cfg_int));
-    ck_assert(0 == avl_del(avl, hash, &data, &cfg_int));
-    ck_assert(-EEXIST == avl_del(avl, hash, &data, &cfg_int));
+    ck_assert(&data == avl_find(avl, hash, &data, &pool, &cfg_int));
+    ck_assert(0 == avl_del(avl, hash, &data, &pool, &cfg_int));
+    ck_assert(-EEXIST == avl_del(avl, hash, &data, &pool, &cfg_int));
 
-    avl_destroy(avl, &cfg_int);
+    avl_destroy(avl, &pool, &cfg_int);
 }
 END_TEST
 
@@ -143,20 +146,20 @@ START_TEST (test_avl_delete_multiple) {
 
     int i;
     for (i = 0; i < 10; i++) {
-        ck_assert(0 == avl_insert(avl, hash[i], &data[i], &cfg_int));
+        ck_assert(0 == avl_insert(avl, hash[i], &data[i], &pool, &cfg_int));
     }
-    ck_assert(avl_node_cnt(avl->root) == 10);
+    ck_assert(avl_node_cnt(avl_root(avl, &pool), &pool) == 10);
 
     for (i = 0; i < 10; i++) {
-        ck_assert(0 == avl_del(avl, hash[i], &data[i], &cfg_int));
+        ck_assert(0 == avl_del(avl, hash[i], &data[i], &pool, &cfg_int));
     }
-    ck_assert(avl_node_cnt(avl->root) == 0);
+    ck_assert(avl_node_cnt(avl_root(avl, &pool), &pool) == 0);
 
     for (i = 0; i < 10; i++) {
-        ck_assert(NULL == avl_find(avl, hash[i], &data[i], &cfg_int));
+        ck_assert(NULL == avl_find(avl, hash[i], &data[i], &pool, &cfg_int));
     }
 
-    avl_destroy(avl, &cfg_int);
+    avl_destroy(avl, &pool, &cfg_int);
 }
 END_TEST
 
@@ -166,11 +169,11 @@ START_TEST (test_avl_find_single) {
     r_hash hash    = 1;
     int* found;
 
-    ck_assert(0 == avl_insert(avl, hash, &data, &cfg_int));
-    found = avl_find(avl, hash, &data, &cfg_int);
+    ck_assert(0 == avl_insert(avl, hash, &data, &pool, &cfg_int));
+    found = avl_find(avl, hash, &data, &pool, &cfg_int);
 
     ck_assert(*found == data);
-    ck_assert(0 == avl_destroy(avl, &cfg_int));
+    ck_assert(0 == avl_destroy(avl, &pool, &cfg_int));
 }
 END_TEST
 
@@ -185,11 +188,11 @@ START_TEST (test_avl_find_multiple) {
     int j;
 
     for (i = 0; i < 10; i++) {
-        ck_assert(0 == avl_insert(avl, hash[i], &data[i], &cfg_int));
+        ck_assert(0 == avl_insert(avl, hash[i], &data[i], &pool, &cfg_int));
     }
 
     for (i = 0; i < 10; i++) {
-        found[i] = (int*) avl_find(avl, hash[i], &data[i], &cfg_int);
+        found[i] = (int*) avl_find(avl, hash[i], &data[i], &pool, &cfg_int);
         ck_assert(found[i] != NULL);
     }
 
@@ -202,7 +205,7 @@ START_TEST (test_avl_find_multiple) {
         }
     }
 
-    avl_destroy(avl, &cfg_int);
+    avl_destroy(avl, &pool, &cfg_int);
 }
 END_TEST
 
@@ -214,11 +217,11 @@ START_TEST (test_avl_cardinality) {
 
     int i;
     for (i = 0; i < 10; i++) {
-        avl_insert(avl, hash[i], &data[i], &cfg_int);
+        avl_insert(avl, hash[i], &data[i], &pool, &cfg_int);
     }
 
     ck_assert(10 == avl_cardinality(avl));
-    avl_destroy(avl, &cfg_int);
+    avl_destroy(avl, &pool, &cfg_int);
 }
 END_TEST
 
@@ -230,12 +233,12 @@ START_TEST (test_avl_cardinality_continuous) {
 
     int i;
     for (i = 0; i < 10; i++) {
-        avl_insert(avl, hash[i], &data[i], &cfg_int);
+        avl_insert(avl, hash[i], &data[i], &pool, &cfg_int);
         ck_assert(i + 1 == avl_cardinality(avl));
     }
 
     ck_assert(10 == avl_cardinality(avl));
-    avl_destroy(avl, &cfg_int);
+    avl_destroy(avl, &pool, &cfg_int);
 }
 END_TEST
 
@@ -247,11 +250,11 @@ START_TEST (test_avl_subset) {
 
     int i;
     for (i = 0; i < 10; i++) {
-        avl_insert(avl, hash[i], &data[i], &cfg_int);
+        avl_insert(avl, hash[i], &data[i], &pool, &cfg_int);
     }
 
-    ck_assert(avl_is_subset(avl, avl, &cfg_int) == 1);
-    avl_destroy(avl, &cfg_int);
+    ck_assert(avl_is_subset(avl, avl, &pool, &pool, &cfg_int) == 1);
+    avl_destroy(avl, &pool, &cfg_int);
 }
 END_TEST
 
@@ -265,15 +268,301 @@ START_TEST (test_avl_subset_distinct) {
 
     int i;
     for (i = 0; i < 10; i++) {
-        avl_insert(avl, hash[i], &data[i], &cfg_int);
+        avl_insert(avl, hash[i], &data[i], &pool, &cfg_int);
     }
     for (i = 0; i < 4; i++) {
-        avl_insert(avl2, hash[i], &data2[i], &cfg_int);
+        avl_insert(avl2, hash[i], &data2[i], &pool, &cfg_int);
     }
 
-    ck_assert(avl_is_subset(avl2, avl, &cfg_int) == 1);
-    ck_assert(avl_is_subset(avl, avl2, &cfg_int) != 1);
-    avl_destroy(avl, &cfg_int);
+    ck_assert(avl_is_subset(avl2, avl, &pool, &pool, &cfg_int) == 1);
+    ck_assert(avl_is_subset(avl, avl2, &pool, &pool, &cfg_int) != 1);
+    avl_destroy(avl, &pool, &cfg_int);
+}
+END_TEST
+
+/*
+ * Check the AVL property of a subtree
+ */
+static int
+is_avl_balanced(struct avl_el const* node) {
+    if (!node) {
+        return 1;
+    }
+    unsigned int l = avl_height(avl_left(node, &pool));
+    unsigned int r = avl_height(avl_right(node, &pool));
+    return (l <= r + 1) && (r <= l + 1) &&
+        is_avl_balanced(avl_left(node, &pool)) &&
+        is_avl_balanced(avl_right(node, &pool));
+}
+
+START_TEST (test_avl_split) {
+    struct avl* avl = calloc(1, sizeof(*avl));
+    struct avl* upper = calloc(1, sizeof(*upper));
+
+    int data[100];
+
+    int i;
+    for (i = 0; i < 100; i++) {
+        data[i] = i;
+        ck_assert(0 == avl_insert(avl, data[i], &data[i], &pool, &cfg_int));
+    }
+
+    avl_split(avl, upper, 50, &pool);
+
+    ck_assert(avl_node_cnt(avl_root(avl, &pool), &pool) == 50);
+    ck_assert(avl_node_cnt(avl_root(upper, &pool), &pool) == 50);
+    ck_assert(avl_cardinality(avl) == 50);
+    ck_assert(avl_cardinality(upper) == 50);
+    ck_assert(is_avl_balanced(avl_root(avl, &pool)));
+    ck_assert(is_avl_balanced(avl_root(upper, &pool)));
+
+    for (i = 0; i < 50; i++) {
+        ck_assert(&data[i] ==
+                  avl_find(avl, data[i], &data[i], &pool, &cfg_int));
+        ck_assert(NULL == avl_find(upper, data[i], &data[i], &pool, &cfg_int));
+    }
+    for (i = 50; i < 100; i++) {
+        ck_assert(NULL == avl_find(avl, data[i], &data[i], &pool, &cfg_int));
+        ck_assert(&data[i] ==
+                  avl_find(upper, data[i], &data[i], &pool, &cfg_int));
+    }
+
+    ck_assert(0 == avl_destroy(avl, &pool, &cfg_int));
+    ck_assert(0 == avl_destroy(upper, &pool, &cfg_int));
+}
+END_TEST
+
+START_TEST (test_avl_join) {
+    struct avl* avl = calloc(1, sizeof(*avl));
+    struct avl* upper = calloc(1, sizeof(*upper));
+
+    int data[100];
+
+    int i;
+    for (i = 0; i < 100; i++) {
+        data[i] = i;
+        struct avl* dest = i < 30 ? avl : upper;
+        ck_assert(0 == avl_insert(dest, data[i], &data[i], &pool, &cfg_int));
+    }
+
+    avl_join(avl, upper, &pool);
+
+    ck_assert(avl_node_cnt(avl_root(avl, &pool), &pool) == 100);
+    ck_assert(avl_cardinality(avl) == 100);
+    ck_assert(avl_root(upper, &pool) == NULL);
+    ck_assert(avl_cardinality(upper) == 0);
+    ck_assert(avl_height(avl_root(avl, &pool)) <= 8);
+    ck_assert(is_avl_balanced(avl_root(avl, &pool)));
+
+    for (i = 0; i < 100; i++) {
+        ck_assert(&data[i] ==
+                  avl_find(avl, data[i], &data[i], &pool, &cfg_int));
+    }
+
+    ck_assert(0 == avl_destroy(avl, &pool, &cfg_int));
+    ck_assert(-EEXIST == avl_destroy(upper, &pool, &cfg_int)); /* empty */
+}
+END_TEST
+
+START_TEST (test_avl_build) {
+    struct avl* avl = calloc(1, sizeof(*avl));
+    struct avl_builder builder;
+
+    int data[100];
+
+    int i;
+    for (i = 0; i < 100; i++) {
+        data[i] = i;
+        if (i % 2) {
+            ck_assert(0 == avl_insert(avl, data[i], &data[i], &pool, &cfg_int));
+        }
+    }
+
+    avl_build_begin(&builder, avl, &pool, &cfg_int);
+    /* two ascending runs, the second one adding nodes below the first one */
+    for (i = 50; i < 100; i++) {
+        ck_assert(0 == avl_build_add(&builder, data[i], &data[i]));
+    }
+    for (i = 0; i < 50; i++) {
+        ck_assert(0 == avl_build_add(&builder, data[i], &data[i]));
+    }
+    /* elements passed out of order or twice */
+    ck_assert(0 == avl_build_add(&builder, data[42], &data[42]));
+    ck_assert(0 == avl_build_add(&builder, data[7], &data[7]));
+    avl_build_end(&builder);
+
+    ck_assert(avl_node_cnt(avl_root(avl, &pool), &pool) == 100);
+    ck_assert(avl_cardinality(avl) == 100);
+    ck_assert(avl_height(avl_root(avl, &pool)) == 7);
+
+    for (i = 0; i < 100; i++) {
+        ck_assert(&data[i] ==
+                  avl_find(avl, data[i], &data[i], &pool, &cfg_int));
+    }
+
+    ck_assert(0 == avl_destroy(avl, &pool, &cfg_int));
+}
+END_TEST
+
+START_TEST (test_avl_balance) {
+    struct avl* avl = calloc(1, sizeof(*avl));
+
+    static int data[1000];
+
+    /* ascending hashes are the worst case for an unbalanced tree */
+    int i;
+    for (i = 0; i < 1000; i++) {
+        data[i] = i;
+        ck_assert(0 == avl_insert(avl, data[i], &data[i], &pool, &cfg_int));
+        ck_assert(is_avl_balanced(avl_root(avl, &pool)));
+    }
+    ck_assert(avl_height(avl_root(avl, &pool)) <= 14);
+
+    for (i = 0; i < 1000; i += 3) {
+        ck_assert(0 == avl_del(avl, data[i], &data[i], &pool, &cfg_int));
+        ck_assert(is_avl_balanced(avl_root(avl, &pool)));
+    }
+    ck_assert(avl_cardinality(avl) == 666);
+    ck_assert(avl_node_cnt(avl_root(avl, &pool), &pool) == 666);
+
+    for (i = 0; i < 1000; i++) {
+        void* expected = (i % 3) ? &data[i] : NULL;
+        ck_assert(expected ==
+                  avl_find(avl, data[i], &data[i], &pool, &cfg_int));
+    }
+
+    ck_assert(0 == avl_destroy(avl, &pool, &cfg_int));
+}
+END_TEST
+
+START_TEST (test_avl_copy) {
+    struct avl avl = { 0 };
+    struct avl copy = { 0 };
+    struct pool copy_pool;
+    pool_init(&copy_pool, &cfg_int);
+
+    static int data[1000];
+
+    /* two elements per hash, inserted in ascending order */
+    int i;
+    for (i = 0; i < 1000; i++) {
+        data[i] = i;
+        ck_assert(0 == avl_insert(&avl, i / 2, &data[i], &pool, &cfg_int));
+    }
+
+    ck_assert(0 == avl_copy(&copy, &avl, &pool, &copy_pool));
+    ck_assert(avl_cardinality(&copy) == 1000);
+    ck_assert(avl_node_cnt(avl_root(&copy, &copy_pool), &copy_pool) == 500);
+    ck_assert(avl_height(avl_root(&copy, &copy_pool)) == 9);
+
+    /* the copy refers to the same elements, the original is untouched */
+    for (i = 0; i < 1000; i++) {
+        ck_assert(&data[i] ==
+                  avl_find(&copy, i / 2, &data[i], &copy_pool, &cfg_int));
+        ck_assert(&data[i] ==
+                  avl_find(&avl, i / 2, &data[i], &pool, &cfg_int));
+    }
+
+    ck_assert(0 == avl_destroy(&avl, &pool, &cfg_int));
+    ck_assert(0 == avl_del(&copy, 7, &data[14], &copy_pool, &cfg_int));
+    ck_assert(NULL == avl_find(&copy, 7, &data[14], &copy_pool, &cfg_int));
+    ck_assert(&data[15] ==
+              avl_find(&copy, 7, &data[15], &copy_pool, &cfg_int));
+    pool_destroy(&copy_pool);
+}
+END_TEST
+
+START_TEST (test_avl_deferred) {
+    struct avl* avl = calloc(1, sizeof(*avl));
+
+    static int data[1000];
+
+    /* ascending hashes degenerate the tree until it gets too deep */
+    int i;
+    for (i = 0; i < 1000; i++) {
+        data[i] = i;
+        ck_assert(0 == avl_insert_deferred(avl, data[i], &data[i], &pool,
+                                           &cfg_int));
+        ck_assert(&data[i] ==
+                  avl_find(avl, data[i], &data[i], &pool, &cfg_int));
+    }
+    ck_assert(-EEXIST == avl_insert_deferred(avl, data[7], &data[7], &pool,
+                                             &cfg_int));
+
+    for (i = 0; i < 1000; i += 3) {
+        ck_assert(0 == avl_del_deferred(avl, data[i], &data[i], &pool,
+                                        &cfg_int));
+    }
+    ck_assert(-EEXIST == avl_del_deferred(avl, data[0], &data[0], &pool,
+                                          &cfg_int));
+    ck_assert(avl_cardinality(avl) == 666);
+
+    avl_rebalance(avl, &pool);
+    ck_assert(is_avl_balanced(avl_root(avl, &pool)));
+    ck_assert(avl_height(avl_root(avl, &pool)) == 10);
+    ck_assert(avl_node_cnt(avl_root(avl, &pool), &pool) == 666);
+
+    for (i = 0; i < 1000; i++) {
+        void* expected = (i % 3) ? &data[i] : NULL;
+        ck_assert(expected ==
+                  avl_find(avl, data[i], &data[i], &pool, &cfg_int));
+    }
+
+    ck_assert(0 == avl_destroy(avl, &pool, &cfg_int));
+}
+END_TEST
+
+/*
+ * Copy an int, failing for negative values
+ */
+static void const*
+copy_nonneg(void const* d) {
+    return (*((int const*) d) < 0) ? NULL : d;
+}
+
+/*
+ * Make sure an element is a valid int
+ */
+static int
+check_int(void* dest, void const* d) {
+    ck_assert(d != NULL);
+    ++*((size_t*) dest);
+    return 0;
+}
+
+START_TEST (test_avl_insert_copy_failure) {
+    struct avl* avl = calloc(1, sizeof(*avl));
+    struct avl* deferred = calloc(1, sizeof(*deferred));
+    struct r_set_cfg cfg = cfg_int;
+    cfg.copyf = copy_nonneg;
+
+    int data[] = { 1, 2, 3, -4, -5 };
+
+    int i;
+    for (i = 0; i < 3; i++) {
+        ck_assert(0 == avl_insert(avl, i, &data[i], &pool, &cfg));
+        ck_assert(0 == avl_insert_deferred(deferred, i, &data[i], &pool,
+                                           &cfg));
+    }
+    /* new nodes, which must not stay in the trees */
+    for (i = 3; i < 5; i++) {
+        ck_assert(-ENOMEM == avl_insert(avl, i, &data[i], &pool, &cfg));
+        ck_assert(-ENOMEM == avl_insert_deferred(deferred, i, &data[i], &pool,
+                                                 &cfg));
+    }
+
+    ck_assert(avl_cardinality(avl) == 3);
+    ck_assert(avl_cardinality(deferred) == 3);
+    ck_assert(avl_node_cnt(avl_root(avl, &pool), &pool) == 3);
+    ck_assert(avl_node_cnt(avl_root(deferred, &pool), &pool) == 3);
+
+    size_t cnt = 0;
+    ck_assert(0 == avl_select(avl, &pool, NULL, NULL, check_int, &cnt));
+    ck_assert(0 == avl_select(deferred, &pool, NULL, NULL, check_int, &cnt));
+    ck_assert(cnt == 6);
+
+    ck_assert(0 == avl_destroy(avl, &pool, &cfg));
+    ck_assert(0 == avl_destroy(deferred, &pool, &cfg));
 }
 END_TEST
 
@@ -285,6 +574,7 @@ suite_avl_create(void) {
     TCase* case_deleting;
     TCase* case_finding;
     TCase* case_subset;
+    TCase* case_split;
 
     s = suite_create("AVL");
 
@@ -294,6 +584,7 @@ suite_avl_create(void) {
     case_deleting   = tcase_create("Deleting");
     case_finding    = tcase_create("Finding");
     case_subset     = tcase_create("Finding");
+    case_split      = tcase_create("Splitting");
 
     /* test adding to test cases */
     tcase_add_test(case_allocfree, test_avl_alloc_destroy);
@@ -304,9 +595,12 @@ suite_avl_create(void) {
     tcase_add_test(case_adding, test_avl_insert_many_distinct);
     tcase_add_test(case_adding, test_avl_insert_multiple_destroy);
     tcase_add_test(case_adding, test_avl_insert_collisions);
+    tcase_add_test(case_adding, test_avl_insert_copy_failure);
 
     tcase_add_test(case_deleting, test_avl_delete);
     tcase_add_test(case_deleting, test_avl_delete_multiple);
+    tcase_add_test(case_deleting, test_avl_balance);
+    tcase_add_test(case_deleting, test_avl_deferred);
 
     tcase_add_test(case_finding, test_avl_find_single);
     tcase_add_test(case_finding, test_avl_find_multiple);
@@ -317,12 +611,25 @@ suite_avl_create(void) {
     tcase_add_test(case_subset, test_avl_subset);
     tcase_add_test(case_subset, test_avl_subset_distinct);
 
+    tcase_add_test(case_split, test_avl_split);
+    tcase_add_test(case_split, test_avl_join);
+    tcase_add_test(case_adding, test_avl_build);
+    tcase_add_test(case_adding, test_avl_copy);
+
+    tcase_add_checked_fixture(case_allocfree, setup_pool, teardown_pool);
+    tcase_add_checked_fixture(case_adding, setup_pool, teardown_pool);
+    tcase_add_checked_fixture(case_deleting, setup_pool, teardown_pool);
+    tcase_add_checked_fixture(case_finding, setup_pool, teardown_pool);
+    tcase_add_checked_fixture(case_subset, setup_pool, teardown_pool);
+    tcase_add_checked_fixture(case_split, setup_pool, teardown_pool);
+
     /* Adding test cases to suite */
     suite_add_tcase(s, case_allocfree);
     suite_add_tcase(s, case_adding);
     suite_add_tcase(s, case_deleting);
     suite_add_tcase(s, case_finding);
     suite_add_tcase(s, case_subset);
+    suite_add_tcase(s, case_split);
 
     return s;
 }
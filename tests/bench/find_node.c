@@ -0,0 +1,119 @@
+/*
+ * Benchmark of lookups in a single avl
+ *
+ * Each size is run with a tree built from random hashes. Reported are the time
+ * per lookup via find_node() and the cache lines holding the lookup fields of
+ * the nodes a descent passes, i.e. the upper bound for its cache misses.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "avl/avl.h"
+#include "avl/common.h"
+#include "set_cfg.h"
+
+#define CACHE_LINE (64)
+#define LOOKUPS (1 << 22)
+
+static uint64_t
+next_random(
+    uint64_t* state
+) {
+    // splitmix64
+    uint64_t z = (*state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+static double
+now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/*
+ * Count the cache lines holding the lookup fields of the nodes passed by the
+ * descent to `hash`
+ */
+static size_t
+lines_per_descent(
+    struct avl const* avl,
+    r_hash hash
+) {
+    size_t lookup_size = offsetof(struct avl_el, filter) + sizeof(bloom);
+    size_t lines = 0;
+
+    struct avl_el const* iter = avl_root(avl, &pool);
+    while (iter) {
+        uintptr_t start = (uintptr_t) iter;
+        lines += (start + lookup_size - 1) / CACHE_LINE - start / CACHE_LINE + 1;
+        if (iter->hash == hash) {
+            break;
+        }
+        iter = (hash < iter->hash) ? avl_left(iter, &pool)
+                                   : avl_right(iter, &pool);
+    }
+    return lines;
+}
+
+static int
+run(
+    size_t n
+) {
+    int* values = malloc(n * sizeof(*values));
+    r_hash* hashes = malloc(n * sizeof(*hashes));
+    if (!values || !hashes) {
+        return -1;
+    }
+
+    struct avl avl = { .root = AVL_NO_LINK, .card = 0 };
+    setup_pool();
+
+    uint64_t state = n;
+    size_t i;
+    for (i = 0; i < n; ++i) {
+        values[i] = (int) i;
+        hashes[i] = (r_hash) next_random(&state);
+        if (avl_insert(&avl, hashes[i], &values[i], &pool, &cfg_int) < 0) {
+            return -1;
+        }
+    }
+
+    double lines = 0;
+    for (i = 0; i < n; ++i) {
+        lines += lines_per_descent(&avl, hashes[i]);
+    }
+
+    // look the hashes up in random order
+    size_t found = 0;
+    double start = now();
+    for (i = 0; i < LOOKUPS; ++i) {
+        found += !!find_node(&avl, hashes[next_random(&state) % n], &pool);
+    }
+    double elapsed = now() - start;
+
+    printf("%10zu nodes, height %2u: %6.1f ns/lookup, %5.2f lines/descent "
+           "(node: %zu bytes)\n", n, avl_height(avl_root(&avl, &pool)),
+           elapsed / LOOKUPS, lines / n, sizeof(struct avl_el));
+
+    avl_destroy(&avl, &pool, &cfg_int);
+    teardown_pool();
+    free(hashes);
+    free(values);
+    return found == LOOKUPS ? 0 : -1;
+}
+
+int
+main(void) {
+    size_t n;
+    for (n = 1 << 10; n <= 1 << 22; n <<= 4) {
+        if (run(n) < 0) {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,144 @@
+#include <check.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "flat/flat.h"
+#include "set_cfg.h"
+
+/*
+ * Build a flat tree from 1000 ints, two of which share a hash each
+ */
+static struct flat
+build_flat(
+    int* data,
+    r_hash* hashes,
+    void** elements
+) {
+    struct avl avl = { 0 };
+
+    int i;
+    for (i = 0; i < 1000; ++i) {
+        data[i] = i;
+        ck_assert(0 == avl_insert(&avl, 2 + 2 * (i / 2), &data[i], &pool,
+                                  &cfg_int));
+    }
+
+    struct flat flat;
+    flat_build(&flat, hashes, elements, &avl, &pool);
+    return flat;
+}
+
+/*
+ * Collect the hashes of the elements fed to it, in an array of 1001 hashes
+ * whose first entry is the number of hashes collected so far
+ */
+static int
+collect_hash(
+    void* etc,
+    r_hash hash,
+    void* data
+) {
+    r_hash* collected = (r_hash*) etc;
+    collected[++collected[0]] = hash;
+    return 0;
+}
+
+START_TEST (test_flat_build) {
+    static int data[1000];
+    static r_hash hashes[1001];
+    static void* elements[1001];
+    struct flat flat = build_flat(data, hashes, elements);
+    ck_assert(flat.card == 1000);
+
+    // each entry is between the entries of its left and right subtrees
+    size_t k;
+    for (k = 1; k <= flat.card; ++k) {
+        if (2 * k <= flat.card) {
+            ck_assert(flat.hashes[2 * k] <= flat.hashes[k]);
+        }
+        if (2 * k + 1 <= flat.card) {
+            ck_assert(flat.hashes[2 * k + 1] >= flat.hashes[k]);
+        }
+        int value = *((int*) flat.data[k]);
+        ck_assert(flat.hashes[k] == (r_hash) (2 + 2 * (value / 2)));
+    }
+}
+END_TEST
+
+START_TEST (test_flat_find) {
+    static int data[1000];
+    static r_hash hashes[1001];
+    static void* elements[1001];
+    struct flat flat = build_flat(data, hashes, elements);
+
+    int i;
+    for (i = 0; i < 1000; ++i) {
+        r_hash hash = 2 + 2 * (i / 2);
+        ck_assert(&data[i] == flat_find(&flat, hash, &data[i], &cfg_int));
+    }
+
+    // neither hashes in between nor hashes outside the range are found
+    int other = 1000;
+    ck_assert(NULL == flat_find(&flat, 0, &other, &cfg_int));
+    ck_assert(NULL == flat_find(&flat, 3, &other, &cfg_int));
+    ck_assert(NULL == flat_find(&flat, 2000, &other, &cfg_int));
+    ck_assert(NULL == flat_find(&flat, SIZE_MAX, &other, &cfg_int));
+
+    // an empty flat tree has no entries at all
+    struct flat empty = { .hashes = hashes, .data = elements, .card = 0 };
+    ck_assert(0 == flat_lower_bound(&empty, 0));
+    ck_assert(NULL == flat_find(&empty, 2, &data[0], &cfg_int));
+}
+END_TEST
+
+START_TEST (test_flat_range_foreach) {
+    static int data[1000];
+    static r_hash hashes[1001];
+    static void* elements[1001];
+    struct flat flat = build_flat(data, hashes, elements);
+
+    // all the elements, in ascending order
+    static r_hash collected[1001];
+    collected[0] = 0;
+    ck_assert(0 == flat_range_foreach(&flat, 0, SIZE_MAX, collect_hash,
+                                      collected));
+    ck_assert(collected[0] == 1000);
+
+    size_t i;
+    for (i = 1; i <= 1000; ++i) {
+        ck_assert(collected[i] == 2 + 2 * ((i - 1) / 2));
+    }
+
+    // the bounds of a range are inclusive
+    collected[0] = 0;
+    ck_assert(0 == flat_range_foreach(&flat, 100, 201, collect_hash,
+                                      collected));
+    ck_assert(collected[0] == 102);
+    ck_assert(collected[1] == 100);
+    ck_assert(collected[102] == 200);
+}
+END_TEST
+
+Suite*
+suite_flat_create(void) {
+    Suite* s;
+    TCase* case_flat;
+
+    s = suite_create("Flat");
+
+    /* Test case creation */
+    case_flat = tcase_create("Building and searching");
+
+    /* test adding to test cases */
+    tcase_add_test(case_flat, test_flat_build);
+    tcase_add_test(case_flat, test_flat_find);
+    tcase_add_test(case_flat, test_flat_range_foreach);
+
+    tcase_add_checked_fixture(case_flat, setup_pool, teardown_pool);
+
+    /* Adding test cases to suite */
+    suite_add_tcase(s, case_flat);
+
+    return s;
+}
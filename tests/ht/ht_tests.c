@@ -3,13 +3,14 @@
 #include <stdlib.h>
 
 #include "ht/ht.h"
+#include "params.h"
 #include "set_cfg.h"
 
 #define LEN(x) (sizeof((x)) / sizeof((x)[0]))
 
 START_TEST (test_ht_init) {
     struct ht ht;
-    ck_assert(&ht == ht_init(&ht, 1)); /* allocate 2^1 */
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int)); /* allocate 2^1 */
 
     ck_assert(ht.buckets != NULL);
     ck_assert(ht.sizeexp == 1);
@@ -23,7 +24,7 @@ START_TEST (test_ht_init_big) {
 
     for (exp = 2; exp < 10; exp++) {
         struct ht ht;
-        ck_assert(&ht == ht_init(&ht, exp)); /* allocate 2^exp */
+        ck_assert(&ht == ht_init(&ht, exp, &cfg_int)); /* allocate 2^exp */
 
         ck_assert(ht.buckets != NULL);
         ck_assert(ht_nbuckets(&ht) == (1 << exp)); /* (1 << exp) == 2^exp */
@@ -73,7 +74,7 @@ START_TEST (test_ht_insert_distinct_values) {
     unsigned int nvals  = map_exp_nvals[_i].nvals;
 
     struct ht ht;
-    ck_assert(&ht == ht_init(&ht, exp));
+    ck_assert(&ht == ht_init(&ht, exp, &cfg_int));
 
     /* allocating on not-cleared stack, assuming to be random inside */
     int vals[nvals];
@@ -90,7 +91,7 @@ END_TEST
 
 START_TEST (test_ht_find_multiple) {
     struct ht ht;
-    ck_assert(&ht == ht_init(&ht, 1)); /* allocate 2^1 */
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int)); /* allocate 2^1 */
 
     int data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
     int i;
@@ -108,7 +109,7 @@ END_TEST
 
 START_TEST (test_ht_del) {
     struct ht ht;
-    ck_assert(&ht == ht_init(&ht, 1)); /* allocate 2^1 */
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int)); /* allocate 2^1 */
 
     int data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
     int i;
@@ -124,9 +125,18 @@ START_TEST (test_ht_del) {
 }
 END_TEST
 
+static int
+is_odd(
+    void const* el,
+    void* etc
+) {
+    (void) etc;
+    return *(int const*) el % 2;
+}
+
 START_TEST (test_ht_cardinality) {
     struct ht ht;
-    ck_assert(&ht == ht_init(&ht, 1)); /* allocate 2^1 */
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int)); /* allocate 2^1 */
 
     int data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
     int i;
@@ -138,13 +148,21 @@ START_TEST (test_ht_cardinality) {
     ck_assert(0 == ht_del(&ht, &data[5], &cfg_int));
     ck_assert(9 == ht_cardinality(&ht));
 
+    /* failed operations must not affect the cardinality */
+    ck_assert(0 != ht_del(&ht, &data[5], &cfg_int));
+    ck_assert(0 != ht_insert(&ht, &data[4], &cfg_int));
+    ck_assert(9 == ht_cardinality(&ht));
+
+    ck_assert(4 == ht_ndel(&ht, is_odd, data, &cfg_int));
+    ck_assert(5 == ht_cardinality(&ht));
+
     ck_assert(0 == ht_destroy(&ht, &cfg_int));
 }
 END_TEST
 
 START_TEST (test_ht_equal) {
     struct ht ht;
-    ck_assert(&ht == ht_init(&ht, 1)); /* allocate 2^1 */
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int)); /* allocate 2^1 */
 
     int data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
     int i;
@@ -160,9 +178,9 @@ END_TEST
 
 START_TEST (test_ht_equal_wrong) {
     struct ht ht;
-    ck_assert(&ht == ht_init(&ht, 1)); /* allocate 2^1 */
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int)); /* allocate 2^1 */
     struct ht ht2;
-    ck_assert(&ht2 == ht_init(&ht2, 2)); /* allocate 2^2 */
+    ck_assert(&ht2 == ht_init(&ht2, 2, &cfg_int)); /* allocate 2^2 */
 
     int data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
     int data2[] = { 1, 1, 2, 3, 4, 6, 6, 7, 8, 9 };
@@ -180,9 +198,9 @@ END_TEST
 
 START_TEST (test_ht_equal_almost) {
     struct ht ht;
-    ck_assert(&ht == ht_init(&ht, 1)); /* allocate 2^1 */
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int)); /* allocate 2^1 */
     struct ht ht2;
-    ck_assert(&ht2 == ht_init(&ht2, 2)); /* allocate 2^2 */
+    ck_assert(&ht2 == ht_init(&ht2, 2, &cfg_int)); /* allocate 2^2 */
 
     int data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
     int data2[] = { 0, 1, 2, 3, 4, 6, 6, 7, 8, 9 };
@@ -200,9 +218,9 @@ END_TEST
 
 START_TEST (test_ht_equal_different_buckets) {
     struct ht ht;
-    ck_assert(&ht == ht_init(&ht, 1)); /* allocate 2^1 */
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int)); /* allocate 2^1 */
     struct ht ht2;
-    ck_assert(&ht2 == ht_init(&ht2, 3)); /* allocate 2^2 */
+    ck_assert(&ht2 == ht_init(&ht2, 3, &cfg_int)); /* allocate 2^2 */
 
     int data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
     int data2[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
@@ -221,9 +239,9 @@ END_TEST
 
 START_TEST (test_ht_equal_different_buckets_wrong) {
     struct ht ht;
-    ck_assert(&ht == ht_init(&ht, 1)); /* allocate 2^1 */
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int)); /* allocate 2^1 */
     struct ht ht2;
-    ck_assert(&ht2 == ht_init(&ht2, 3)); /* allocate 2^3 */
+    ck_assert(&ht2 == ht_init(&ht2, 3, &cfg_int)); /* allocate 2^3 */
 
     int data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
     int data2[] = { 0, 1, 2, 3, 4, 5, 6,    8, 9, 10 };
@@ -242,6 +260,220 @@ START_TEST (test_ht_equal_different_buckets_wrong) {
 }
 END_TEST
 
+#define MANY_INTS_CNT 10000
+
+START_TEST (test_ht_grow) {
+    struct ht ht;
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int_spread)); /* allocate 2^1 */
+
+    static int data[MANY_INTS_CNT];
+    int i;
+    for (i = 0; i < MANY_INTS_CNT; ++i) {
+        data[i] = i;
+        ck_assert(0 == ht_insert(&ht, &data[i], &cfg_int_spread));
+    }
+
+    /* the buckets should hold only few elements each */
+    ck_assert(ht_nbuckets(&ht) >= MANY_INTS_CNT / 16);
+    ck_assert(ht_cardinality(&ht) == MANY_INTS_CNT);
+
+    for (i = 0; i < MANY_INTS_CNT; ++i) {
+        ck_assert(&data[i] == ht_find(&ht, &data[i], &cfg_int_spread));
+    }
+
+    ck_assert(0 == ht_destroy(&ht, &cfg_int_spread));
+}
+END_TEST
+
+START_TEST (test_ht_grow_incremental) {
+    struct ht ht;
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int_spread)); /* allocate 2^1 */
+    struct ht ht2;
+    ck_assert(&ht2 == ht_init(&ht2, 3, &cfg_int_spread)); /* allocate 2^3 */
+
+    static int data[MANY_INTS_CNT];
+    int seen_migration = 0;
+    int i;
+    for (i = 0; i < MANY_INTS_CNT; ++i) {
+        data[i] = i;
+        ck_assert(0 == ht_insert(&ht, &data[i], &cfg_int_spread));
+        ck_assert(0 == ht_insert(&ht2, &data[i], &cfg_int_spread));
+
+        if (!ht.old_buckets || seen_migration) {
+            continue;
+        }
+
+        /* operations must not be affected by the resize in progress */
+        seen_migration = 1;
+        ck_assert(ht_cardinality(&ht) == (size_t) i + 1);
+        ck_assert(ht_equal(&ht, &ht2, &cfg_int_spread) == 1);
+        ck_assert(ht_equal(&ht2, &ht, &cfg_int_spread) == 1);
+
+        int j;
+        for (j = 0; j <= i; ++j) {
+            ck_assert(&data[j] == ht_find(&ht, &data[j], &cfg_int_spread));
+        }
+        ck_assert(0 == ht_del(&ht, &data[i], &cfg_int_spread));
+        ck_assert(NULL == ht_find(&ht, &data[i], &cfg_int_spread));
+        ck_assert(0 == ht_insert(&ht, &data[i], &cfg_int_spread));
+    }
+    ck_assert(seen_migration || (HT_MIGRATION_STEP == 0));
+
+    for (i = 0; i < MANY_INTS_CNT; ++i) {
+        ck_assert(&data[i] == ht_find(&ht, &data[i], &cfg_int_spread));
+    }
+
+    ck_assert(0 == ht_destroy(&ht, &cfg_int_spread));
+    ck_assert(0 == ht_destroy(&ht2, &cfg_int_spread));
+}
+END_TEST
+
+START_TEST (test_ht_migration_progress) {
+    struct ht ht;
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int_spread)); /* allocate 2^1 */
+
+    static int data[MANY_INTS_CNT];
+    int i;
+    for (i = 0; (i < MANY_INTS_CNT) && !ht.old_buckets; ++i) {
+        data[i] = i;
+        ck_assert(0 == ht_insert(&ht, &data[i], &cfg_int_spread));
+    }
+    if (HT_MIGRATION_STEP == 0) {
+        ck_assert(ht.old_buckets == NULL);
+        ck_assert(0 == ht_destroy(&ht, &cfg_int_spread));
+        return;
+    }
+    ck_assert(ht.old_buckets != NULL);
+    int n = i;
+
+    /* lookups do not advance the migration */
+    int j;
+    for (j = 0; j < 100 * n; ++j) {
+        ck_assert(&data[j % n] ==
+                  ht_find(&ht, &data[j % n], &cfg_int_spread));
+    }
+    ck_assert(ht.old_buckets != NULL);
+
+    /* each removal and insertion does, even without changing the contents */
+    size_t units = CONSTPOW_TWO(MIN(ht.sizeexp, ht.old_sizeexp));
+    size_t ops = 0;
+    while (ht.old_buckets) {
+        ck_assert(ops <= units / HT_MIGRATION_STEP);
+        ck_assert(0 == ht_del(&ht, &data[0], &cfg_int_spread));
+        ck_assert(0 == ht_insert(&ht, &data[0], &cfg_int_spread));
+        ++ops;
+    }
+
+    ck_assert(ht_cardinality(&ht) == (size_t) n);
+    for (j = 0; j < n; ++j) {
+        ck_assert(&data[j] == ht_find(&ht, &data[j], &cfg_int_spread));
+    }
+
+    ck_assert(0 == ht_destroy(&ht, &cfg_int_spread));
+}
+END_TEST
+
+START_TEST (test_ht_shrink) {
+    struct ht ht;
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int_spread)); /* allocate 2^1 */
+
+    static int data[MANY_INTS_CNT];
+    int i;
+    for (i = 0; i < MANY_INTS_CNT; ++i) {
+        data[i] = i;
+        ck_assert(0 == ht_insert(&ht, &data[i], &cfg_int_spread));
+    }
+    size_t grown = ht.sizeexp;
+
+    /* delete all but a few elements */
+    for (i = 0; i < MANY_INTS_CNT - 10; ++i) {
+        ck_assert(0 == ht_del(&ht, &data[i], &cfg_int_spread));
+    }
+    ck_assert(ht.sizeexp < grown);
+    ck_assert(ht.sizeexp >= 1);
+    ck_assert(ht_cardinality(&ht) == 10);
+
+    for (i = 0; i < MANY_INTS_CNT - 10; ++i) {
+        ck_assert(NULL == ht_find(&ht, &data[i], &cfg_int_spread));
+    }
+    for (; i < MANY_INTS_CNT; ++i) {
+        ck_assert(&data[i] == ht_find(&ht, &data[i], &cfg_int_spread));
+    }
+
+    ck_assert(0 == ht_destroy(&ht, &cfg_int_spread));
+}
+END_TEST
+
+START_TEST (test_ht_reserve) {
+    struct ht ht;
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int_spread)); /* allocate 2^1 */
+
+    static int data[MANY_INTS_CNT];
+    int i;
+    for (i = 0; i < 100; ++i) {
+        data[i] = i;
+        ck_assert(0 == ht_insert(&ht, &data[i], &cfg_int_spread));
+    }
+
+    ck_assert(0 == ht_reserve(&ht, MANY_INTS_CNT));
+    size_t reserved = ht.sizeexp;
+    ck_assert(reserved == ht_sizeexp_for(MANY_INTS_CNT));
+    ck_assert(ht.old_buckets == NULL);
+
+    for (; i < MANY_INTS_CNT; ++i) {
+        data[i] = i;
+        ck_assert(0 == ht_insert(&ht, &data[i], &cfg_int_spread));
+    }
+    ck_assert(ht.sizeexp == reserved);
+
+    /* the table must not shrink below the reserved size */
+    for (i = 0; i < MANY_INTS_CNT; ++i) {
+        ck_assert(&data[i] == ht_find(&ht, &data[i], &cfg_int_spread));
+        ck_assert(0 == ht_del(&ht, &data[i], &cfg_int_spread));
+    }
+    ck_assert(ht.sizeexp == reserved);
+
+    ck_assert(0 == ht_destroy(&ht, &cfg_int_spread));
+}
+END_TEST
+
+START_TEST (test_ht_insert_bulk) {
+    struct ht ht;
+    ck_assert(&ht == ht_init(&ht, 1, &cfg_int_spread)); /* allocate 2^1 */
+
+    static int data[MANY_INTS_CNT];
+    static void* elems[MANY_INTS_CNT + 100];
+    int i;
+    for (i = 0; i < MANY_INTS_CNT; ++i) {
+        data[i] = i;
+        if (i % 3 == 0) {
+            ck_assert(0 == ht_insert(&ht, &data[i], &cfg_int_spread));
+        }
+    }
+
+    /* in no particular order, with elements already inserted and duplicates */
+    for (i = 0; i < MANY_INTS_CNT; ++i) {
+        elems[i] = &data[(i * 7919) % MANY_INTS_CNT];
+    }
+    for (i = 0; i < 100; ++i) {
+        elems[MANY_INTS_CNT + i] = &data[i];
+    }
+    ck_assert(0 == ht_insert_bulk(&ht, elems, MANY_INTS_CNT + 100,
+                                  &cfg_int_spread));
+    ck_assert(ht_cardinality(&ht) == MANY_INTS_CNT);
+    ck_assert(ht.sizeexp >= ht_sizeexp_for(MANY_INTS_CNT));
+
+    for (i = 0; i < MANY_INTS_CNT; ++i) {
+        ck_assert(&data[i] == ht_find(&ht, &data[i], &cfg_int_spread));
+    }
+
+    ck_assert(0 == ht_insert_bulk(&ht, elems, 0, &cfg_int_spread));
+    ck_assert(ht_cardinality(&ht) == MANY_INTS_CNT);
+
+    ck_assert(0 == ht_destroy(&ht, &cfg_int_spread));
+}
+END_TEST
+
 Suite*
 suite_ht_create(void) {
     Suite* s;
@@ -251,6 +483,7 @@ suite_ht_create(void) {
     TCase* case_deleting;
     TCase* case_cardinality;
     TCase* case_equality;
+    TCase* case_resize;
 
     s = suite_create("HT");
 
@@ -261,6 +494,7 @@ suite_ht_create(void) {
     case_deleting    = tcase_create("Deleting");
     case_cardinality = tcase_create("Cardinality");
     case_equality = tcase_create("Equality");
+    case_resize = tcase_create("Resizing");
 
     /* test adding to test cases */
     tcase_add_test(case_allocfree, test_ht_init);
@@ -270,6 +504,7 @@ suite_ht_create(void) {
                         test_ht_insert_distinct_values,
                         0,
                         LEN(map_exp_nvals));
+    tcase_add_test(case_adding, test_ht_insert_bulk);
     tcase_add_test(case_finding, test_ht_find_multiple);
 
     tcase_add_test(case_deleting, test_ht_del);
@@ -282,6 +517,12 @@ suite_ht_create(void) {
     tcase_add_test(case_equality, test_ht_equal_different_buckets);
     tcase_add_test(case_equality, test_ht_equal_different_buckets_wrong);
 
+    tcase_add_test(case_resize, test_ht_grow);
+    tcase_add_test(case_resize, test_ht_grow_incremental);
+    tcase_add_test(case_resize, test_ht_migration_progress);
+    tcase_add_test(case_resize, test_ht_shrink);
+    tcase_add_test(case_resize, test_ht_reserve);
+
     /* Adding test cases to suite */
     suite_add_tcase(s, case_allocfree);
     suite_add_tcase(s, case_adding);
@@ -289,6 +530,7 @@ suite_ht_create(void) {
     suite_add_tcase(s, case_deleting);
     suite_add_tcase(s, case_cardinality);
     suite_add_tcase(s, case_equality);
+    suite_add_tcase(s, case_resize);
 
     return s;
 }
@@ -16,10 +16,10 @@ predicate_lower_five(
 START_TEST (test_ll_insert_data) {
     struct ll* ll = calloc(1, sizeof(*ll));
     int data = 5;
-    ck_assert(0 == ll_insert(ll, &data, &cfg_int));
+    ck_assert(0 == ll_insert(ll, &data, &pool, &cfg_int));
 
-    ck_assert(0 == ll_delete(ll, &data, &cfg_int));
-    ck_assert(0 != ll_delete(ll, &data, &cfg_int));
+    ck_assert(0 == ll_delete(ll, &data, &pool, &cfg_int));
+    ck_assert(0 != ll_delete(ll, &data, &pool, &cfg_int));
 
     free(ll);
 }
@@ -29,13 +29,13 @@ START_TEST (test_ll_delete_data) {
     struct ll* ll = calloc(1, sizeof(*ll));
     int data = 7;
 
-    ck_assert(0 == ll_insert(ll, &data, &cfg_int));
-    ck_assert(&data == ll_find(ll, &data, &cfg_int));
+    ck_assert(0 == ll_insert(ll, &data, &pool, &cfg_int));
+    ck_assert(&data == ll_find(ll, &data, &pool, &cfg_int));
 
-    ck_assert(0 == ll_delete(ll, &data, &cfg_int));
-    ck_assert(&data != ll_find(ll, &data, &cfg_int));
+    ck_assert(0 == ll_delete(ll, &data, &pool, &cfg_int));
+    ck_assert(&data != ll_find(ll, &data, &pool, &cfg_int));
 
-    ck_assert(0 != ll_delete(ll, ll->head, &cfg_int));
+    ck_assert(0 != ll_delete(ll, &data, &pool, &cfg_int));
 
     free(ll);
 }
@@ -49,24 +49,24 @@ START_TEST (test_ll_insert_multiple) {
     };
 
     for (i = 0; i < 10; i++) {
-        ck_assert(0 == ll_insert(ll, &(data[i]), &cfg_int));
-        ck_assert(&(data[i]) == ll_find(ll, &(data[i]), &cfg_int));
+        ck_assert(0 == ll_insert(ll, &(data[i]), &pool, &cfg_int));
+        ck_assert(&(data[i]) == ll_find(ll, &(data[i]), &pool, &cfg_int));
     }
 
     for (i = 0; i < 10; i++) {
-        ck_assert(0 == ll_delete(ll, &(data[i]), &cfg_int));
+        ck_assert(0 == ll_delete(ll, &(data[i]), &pool, &cfg_int));
 
         /*
          * check that none of the elements in the LL holds the data we just
          * removed
          */
-        ck_assert(&(data[i]) != ll_find(ll, &(data[i]), &cfg_int));
-        ck_assert(NULL == ll_find(ll, &(data[i]), &cfg_int));
+        ck_assert(&(data[i]) != ll_find(ll, &(data[i]), &pool, &cfg_int));
+        ck_assert(NULL == ll_find(ll, &(data[i]), &pool, &cfg_int));
     }
 
-    ck_assert(ll->head == NULL);
+    ck_assert(ll_is_empty(ll));
 
-    ll_destroy(ll, &cfg_int);
+    ll_destroy(ll, &pool, &cfg_int);
     free(ll);
 }
 END_TEST
@@ -77,12 +77,12 @@ START_TEST (test_ll_insert_multiple_same) {
         0, 0
     };
 
-    ck_assert(0 == ll_insert(ll, &(data[0]), &cfg_int));
-    ck_assert(0 != ll_insert(ll, &(data[1]), &cfg_int));
+    ck_assert(0 == ll_insert(ll, &(data[0]), &pool, &cfg_int));
+    ck_assert(0 != ll_insert(ll, &(data[1]), &pool, &cfg_int));
 
-    ck_assert(0 == ll_delete(ll, &(data[0]), &cfg_int));
+    ck_assert(0 == ll_delete(ll, &(data[0]), &pool, &cfg_int));
 
-    ll_destroy(ll, &cfg_int);
+    ll_destroy(ll, &pool, &cfg_int);
     free(ll);
 }
 END_TEST
@@ -94,23 +94,23 @@ START_TEST (test_ll_delete_by_predicate) {
     int data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
 
     for (i = 0; i < 10; i++) {
-        ck_assert(0 == ll_insert(ll, &(data[i]), &cfg_int));
+        ck_assert(0 == ll_insert(ll, &(data[i]), &pool, &cfg_int));
     }
 
-    ndel = ll_ndel(ll, predicate_lower_five, NULL, &cfg_int);
+    ndel = ll_ndel(ll, predicate_lower_five, NULL, &pool, &cfg_int);
 
     /* We delete 0-4, which are 5 numbers */
     ck_assert(ndel == 5);
 
     for (i = 0; i < 5; i++) {
-        ck_assert(NULL == ll_find(ll, &i, &cfg_int));
+        ck_assert(NULL == ll_find(ll, &i, &pool, &cfg_int));
     }
     for (i = 5; i < 10; i++) {
-        ck_assert(NULL != ll_find(ll, &i, &cfg_int));
-        ck_assert(&i != ll_find(ll, &i, &cfg_int));
+        ck_assert(NULL != ll_find(ll, &i, &pool, &cfg_int));
+        ck_assert(&i != ll_find(ll, &i, &pool, &cfg_int));
     }
 
-    ll_destroy(ll, &cfg_int);
+    ll_destroy(ll, &pool, &cfg_int);
     free(ll);
 }
 END_TEST
@@ -119,17 +119,17 @@ START_TEST (test_ll_is_empty_after_insertion_and_deletion) {
     struct ll* ll = malloc(sizeof(*ll));
     int data[] = { 0, 1 };
 
-    ck_assert(0 == ll_insert(ll, &(data[0]), &cfg_int));
-    ck_assert(0 == ll_insert(ll, &(data[1]), &cfg_int));
+    ck_assert(0 == ll_insert(ll, &(data[0]), &pool, &cfg_int));
+    ck_assert(0 == ll_insert(ll, &(data[1]), &pool, &cfg_int));
 
-    struct ll_element* old_head = ll->head;
-    ck_assert(0 == ll_delete(ll, &(data[0]), &cfg_int));
-    ck_assert(old_head != ll->head);
+    void* old_head = ll->head.data;
+    ck_assert(0 == ll_delete(ll, &(data[0]), &pool, &cfg_int));
+    ck_assert(old_head != ll->head.data);
 
-    ck_assert(0 == ll_delete(ll, &(data[1]), &cfg_int));
+    ck_assert(0 == ll_delete(ll, &(data[1]), &pool, &cfg_int));
 
     ck_assert(ll_is_empty(ll));
-    ll_destroy(ll, &cfg_int);
+    ll_destroy(ll, &pool, &cfg_int);
 }
 END_TEST
 
@@ -139,11 +139,11 @@ START_TEST (test_ll_count) {
     int data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
 
     for (i = 0; i < 10; i++) {
-        ck_assert(0 == ll_insert(ll, &(data[i]), &cfg_int));
+        ck_assert(0 == ll_insert(ll, &(data[i]), &pool, &cfg_int));
     }
 
-    ck_assert(ll_count(ll) == 10);
-    ll_destroy(ll, &cfg_int);
+    ck_assert(ll_count(ll, &pool) == 10);
+    ll_destroy(ll, &pool, &cfg_int);
 }
 END_TEST
 
@@ -153,12 +153,12 @@ START_TEST (test_ll_subset) {
     int data[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
 
     for (i = 0; i < 10; i++) {
-        ck_assert(ll_insert(ll, &(data[i]), &cfg_int) == 0);
+        ck_assert(ll_insert(ll, &(data[i]), &pool, &cfg_int) == 0);
     }
 
-    ck_assert(ll_is_subset(ll, ll, &cfg_int) == 1);
+    ck_assert(ll_is_subset(ll, ll, &pool, &pool, &cfg_int) == 1);
 
-    ll_destroy(ll, &cfg_int);
+    ll_destroy(ll, &pool, &cfg_int);
 }
 END_TEST
 
@@ -170,14 +170,14 @@ START_TEST (test_ll_subset_distinct_wrong) {
     int data2[] = { 0, 1, 2, 3, 4, 5, 6,    8, 9, 10 };
 
     for (i = 0; i < 10; i++) {
-        ck_assert(ll_insert(ll, &(data[i]), &cfg_int) == 0);
-        ck_assert(ll_insert(ll2, &(data2[i]), &cfg_int) == 0);
+        ck_assert(ll_insert(ll, &(data[i]), &pool, &cfg_int) == 0);
+        ck_assert(ll_insert(ll2, &(data2[i]), &pool, &cfg_int) == 0);
     }
 
-    ck_assert(ll_is_subset(ll2, ll, &cfg_int) != 1);
-    ck_assert(ll_is_subset(ll, ll2, &cfg_int) != 1);
+    ck_assert(ll_is_subset(ll2, ll, &pool, &pool, &cfg_int) != 1);
+    ck_assert(ll_is_subset(ll, ll2, &pool, &pool, &cfg_int) != 1);
 
-    ll_destroy(ll, &cfg_int);
+    ll_destroy(ll, &pool, &cfg_int);
 }
 END_TEST
 
@@ -189,16 +189,16 @@ START_TEST (test_ll_subset_distinct) {
     int data2[] = { 0, 1, 2, 3 };
 
     for (i = 0; i < 10; i++) {
-        ck_assert(ll_insert(ll, &(data[i]), &cfg_int) == 0);
+        ck_assert(ll_insert(ll, &(data[i]), &pool, &cfg_int) == 0);
     }
     for (i = 0; i < 4; i++) {
-        ck_assert(ll_insert(ll2, &(data2[i]), &cfg_int) == 0);
+        ck_assert(ll_insert(ll2, &(data2[i]), &pool, &cfg_int) == 0);
     }
 
-    ck_assert(ll_is_subset(ll2, ll, &cfg_int) == 1);
-    ck_assert(ll_is_subset(ll, ll2, &cfg_int) != 1);
+    ck_assert(ll_is_subset(ll2, ll, &pool, &pool, &cfg_int) == 1);
+    ck_assert(ll_is_subset(ll, ll2, &pool, &pool, &cfg_int) != 1);
 
-    ll_destroy(ll, &cfg_int);
+    ll_destroy(ll, &pool, &cfg_int);
 }
 END_TEST
 
@@ -233,6 +233,11 @@ suite_ll_create(void) {
     tcase_add_test(case_subset, test_ll_subset_distinct);
     tcase_add_test(case_subset, test_ll_subset_distinct_wrong);
 
+    tcase_add_checked_fixture(case_insert, setup_pool, teardown_pool);
+    tcase_add_checked_fixture(case_delete, setup_pool, teardown_pool);
+    tcase_add_checked_fixture(case_empty, setup_pool, teardown_pool);
+    tcase_add_checked_fixture(case_subset, setup_pool, teardown_pool);
+
     /* Adding test cases to suite */
     suite_add_tcase(s, case_insert);
     suite_add_tcase(s, case_delete);
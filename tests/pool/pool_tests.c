@@ -0,0 +1,128 @@
+#include <check.h>
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "pool.h"
+#include "set_cfg.h"
+
+START_TEST (test_pool_alloc_free) {
+    struct pool pool;
+    pool_init(&pool, &cfg_int);
+
+    size_t* obj = pool_alloc(&pool, sizeof(*obj) * 3);
+    ck_assert(obj != NULL);
+    ck_assert(((uintptr_t) obj) % POOL_GRANULE == 0);
+    ck_assert(obj[0] == 0 && obj[1] == 0 && obj[2] == 0);
+
+    obj[0] = obj[1] = obj[2] = 42;
+    pool_free(&pool, obj, sizeof(*obj) * 3);
+
+    // the object is reused and zeroed again
+    size_t* again = pool_alloc(&pool, sizeof(*again) * 3);
+    ck_assert(again == obj);
+    ck_assert(again[0] == 0 && again[1] == 0 && again[2] == 0);
+
+    pool_destroy(&pool);
+}
+END_TEST
+
+START_TEST (test_pool_alloc_adjacent) {
+    struct pool pool;
+    pool_init(&pool, &cfg_int);
+
+    char* first = pool_alloc(&pool, 16);
+    char* second = pool_alloc(&pool, 56);
+    char* third = pool_alloc(&pool, 8);
+    ck_assert(second == first + 16);
+    ck_assert(third == second + 56);
+
+    pool_destroy(&pool);
+}
+END_TEST
+
+START_TEST (test_pool_alloc_many) {
+    struct pool pool;
+    pool_init(&pool, &cfg_int);
+
+    size_t i;
+    size_t* objs[10000];
+    for (i = 0; i < 10000; ++i) {
+        objs[i] = pool_alloc(&pool, sizeof(**objs) * (1 + i % 8));
+        ck_assert(objs[i] != NULL);
+        *objs[i] = i;
+    }
+    for (i = 0; i < 10000; ++i) {
+        ck_assert(*objs[i] == i);
+    }
+    for (i = 0; i < 10000; i += 2) {
+        pool_free(&pool, objs[i], sizeof(**objs) * (1 + i % 8));
+    }
+
+    // large objects are served, too
+    char* large = pool_alloc(&pool, 4096);
+    ck_assert(large != NULL);
+    ck_assert(large[4096 - 1] == 0);
+    pool_free(&pool, large, 4096);
+
+    pool_destroy(&pool);
+    ck_assert(pool.chunks == NULL);
+}
+END_TEST
+
+#ifdef INDEX_LINKS
+START_TEST (test_pool_refs) {
+    struct pool pool;
+    pool_init(&pool, &cfg_int);
+
+    size_t i;
+    size_t* objs[10000];
+    pool_ref refs[10000];
+    for (i = 0; i < 10000; ++i) {
+        objs[i] = pool_alloc_ref(&pool, sizeof(**objs) * (1 + i % 8), &refs[i]);
+        ck_assert(objs[i] != NULL);
+        ck_assert(((uintptr_t) objs[i]) % POOL_GRANULE == 0);
+    }
+
+    // objects in all the chunks resolve to themselves, but never to 0
+    for (i = 0; i < 10000; ++i) {
+        ck_assert(refs[i] != 0);
+        ck_assert(pool_deref(&pool, refs[i]) == objs[i]);
+    }
+
+    // reused objects keep their references
+    pool_free_ref(&pool, refs[42], sizeof(**objs) * (1 + 42 % 8));
+    pool_ref ref;
+    size_t* again = pool_alloc_ref(&pool, sizeof(**objs) * (1 + 42 % 8), &ref);
+    ck_assert(again == objs[42]);
+    ck_assert(ref == refs[42]);
+    ck_assert(*again == 0);
+
+    pool_destroy(&pool);
+}
+END_TEST
+#endif
+
+Suite*
+suite_pool_create(void) {
+    Suite* s;
+    TCase* case_alloc;
+
+    s = suite_create("Pool");
+
+    /* Test case creation */
+    case_alloc = tcase_create("Allocating and freeing");
+
+    /* test adding to test cases */
+    tcase_add_test(case_alloc, test_pool_alloc_free);
+    tcase_add_test(case_alloc, test_pool_alloc_adjacent);
+    tcase_add_test(case_alloc, test_pool_alloc_many);
+#ifdef INDEX_LINKS
+    tcase_add_test(case_alloc, test_pool_refs);
+#endif
+
+    /* Adding test cases to suite */
+    suite_add_tcase(s, case_alloc);
+
+    return s;
+}
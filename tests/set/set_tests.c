@@ -1,10 +1,23 @@
 #include <check.h>
 
 #include <stdlib.h>
+#include <errno.h>
 
 #include "libreset/set.h"
 #include "set_cfg.h"
 
+/**
+ * Number of elements freed by count_free()
+ */
+static size_t nfreed;
+
+static void
+count_free(
+    void* data
+) {
+    ++nfreed;
+}
+
 START_TEST (test_r_set_cardinality) {
     struct r_set* set = r_set_new(&cfg_int);
     int data = 1;
@@ -13,6 +26,35 @@ START_TEST (test_r_set_cardinality) {
 }
 END_TEST
 
+START_TEST (test_r_set_from_array) {
+    static int data[1000];
+    static void* elems[1500];
+    int i;
+    for (i = 0; i < 1500; ++i) {
+        data[i % 1000] = i % 1000;
+        elems[i] = &data[(i * 3) % 1000];
+    }
+
+    // the duplicates are only inserted once
+    struct r_set* set = r_set_from_array(&cfg_int_spread, elems, 1500);
+    ck_assert(set != NULL);
+    ck_assert(1000 == r_set_cardinality(set));
+
+    struct r_set* other = r_set_new(&cfg_int_spread);
+    for (i = 0; i < 500; ++i) {
+        ck_assert(0 == r_set_insert(other, &data[i]));
+    }
+    ck_assert(0 == r_set_insert_bulk(other, elems + 500, 1000));
+    ck_assert(r_set_equal(set, other));
+
+    ck_assert(0 == r_set_freeze(other));
+    ck_assert(-EPERM == r_set_insert_bulk(other, elems, 1));
+
+    ck_assert(0 == r_set_destroy(set));
+    ck_assert(0 == r_set_destroy(other));
+}
+END_TEST
+
 START_TEST (test_r_set_equal) {
     struct r_set* set = r_set_new(&cfg_int);
     struct r_set* set2 = r_set_new(&cfg_int);
@@ -29,26 +71,879 @@ START_TEST (test_r_set_equal) {
 }
 END_TEST
 
+START_TEST (test_r_set_is_subset) {
+    static int data[2000];
+    struct r_set* set_a = r_set_new(&cfg_int_spread);
+    struct r_set* set_b = r_set_new_with_capacity(&cfg_int_spread, 20000);
+    struct r_set* empty = r_set_new(&cfg_int_spread);
+
+    int i;
+    for (i = 0; i < 2000; ++i) {
+        data[i] = i;
+        if (i < 1000) {
+            ck_assert(0 == r_set_insert(set_a, &data[i]));
+        }
+        ck_assert(0 == r_set_insert(set_b, &data[i]));
+    }
+
+    ck_assert(1 == r_set_is_subset(set_a, set_b));
+    ck_assert(0 == r_set_is_subset(set_b, set_a));
+    ck_assert(1 == r_set_is_subset(set_a, set_a));
+    ck_assert(1 == r_set_is_subset(empty, set_a));
+    ck_assert(0 == r_set_is_subset(set_a, empty));
+
+    /* a single missing element breaks the relation */
+    ck_assert(0 == r_set_remove(set_b, &data[700]));
+    ck_assert(0 == r_set_is_subset(set_a, set_b));
+    ck_assert(0 == r_set_remove(set_a, &data[700]));
+    ck_assert(1 == r_set_is_subset(set_a, set_b));
+
+    ck_assert(0 == r_set_destroy(set_a));
+    ck_assert(0 == r_set_destroy(set_b));
+    ck_assert(0 == r_set_destroy(empty));
+}
+END_TEST
+
+START_TEST (test_r_set_operation_cardinality) {
+    static int data[2000];
+    struct r_set* set_a = r_set_new(&cfg_int_spread);
+    struct r_set* set_b = r_set_new_with_capacity(&cfg_int_spread, 20000);
+    struct r_set* empty = r_set_new(&cfg_int_spread);
+
+    int i;
+    for (i = 0; i < 2000; ++i) {
+        data[i] = i;
+        if (i < 1000) {
+            ck_assert(0 == r_set_insert(set_a, &data[i]));
+        }
+        if (i >= 500) {
+            ck_assert(0 == r_set_insert(set_b, &data[i]));
+        }
+    }
+
+    ck_assert(2000 == r_set_union_cardinality(set_a, set_b));
+    ck_assert(500 == r_set_intersection_cardinality(set_a, set_b));
+    ck_assert(500 == r_set_intersection_cardinality(set_b, set_a));
+    ck_assert(1500 == r_set_xor_cardinality(set_a, set_b));
+    ck_assert(500 == r_set_exclude_cardinality(set_a, set_b));
+    ck_assert(1000 == r_set_exclude_cardinality(set_b, set_a));
+
+    ck_assert(1000 == r_set_intersection_cardinality(set_a, set_a));
+    ck_assert(0 == r_set_xor_cardinality(set_a, set_a));
+    ck_assert(0 == r_set_intersection_cardinality(set_a, empty));
+    ck_assert(1000 == r_set_union_cardinality(empty, set_a));
+
+    /* sets with different configurations have no common elements */
+    struct r_set_cfg cfg = cfg_int_spread;
+    cfg.freef = count_free;
+    struct r_set* other = r_set_new(&cfg);
+    for (i = 0; i < 1000; ++i) {
+        ck_assert(0 == r_set_insert(other, &data[i]));
+    }
+    ck_assert(0 == r_set_intersection_cardinality(set_a, other));
+    ck_assert(2000 == r_set_union_cardinality(set_a, other));
+    ck_assert(2000 == r_set_xor_cardinality(set_a, other));
+    ck_assert(1000 == r_set_exclude_cardinality(set_a, other));
+    ck_assert(0 == r_set_destroy(other));
+
+    ck_assert(0 == r_set_destroy(set_a));
+    ck_assert(0 == r_set_destroy(set_b));
+    ck_assert(0 == r_set_destroy(empty));
+}
+END_TEST
+
+START_TEST (test_r_set_disjoint) {
+    static int data[2000];
+    struct r_set* set_a = r_set_new(&cfg_int_spread);
+    struct r_set* set_b = r_set_new_with_capacity(&cfg_int_spread, 20000);
+    struct r_set* empty = r_set_new(&cfg_int_spread);
+
+    int i;
+    for (i = 0; i < 2000; ++i) {
+        data[i] = i;
+        if (i < 1000) {
+            ck_assert(0 == r_set_insert(set_a, &data[i]));
+        } else {
+            ck_assert(0 == r_set_insert(set_b, &data[i]));
+        }
+    }
+
+    ck_assert(1 == r_set_disjoint(set_a, set_b));
+    ck_assert(1 == r_set_disjoint(set_b, set_a));
+    ck_assert(1 == r_set_disjoint(set_a, empty));
+    ck_assert(1 == r_set_disjoint(empty, empty));
+    ck_assert(0 == r_set_disjoint(set_a, set_a));
+
+    /* a single common element */
+    ck_assert(0 == r_set_insert(set_b, &data[700]));
+    ck_assert(0 == r_set_disjoint(set_a, set_b));
+    ck_assert(0 == r_set_disjoint(set_b, set_a));
+
+    /* sets with different configurations are disjoint */
+    struct r_set_cfg cfg = cfg_int_spread;
+    cfg.freef = count_free;
+    struct r_set* other = r_set_new(&cfg);
+    ck_assert(0 == r_set_insert(other, &data[700]));
+    ck_assert(1 == r_set_disjoint(set_a, other));
+    ck_assert(1 == r_set_disjoint(other, set_a));
+    ck_assert(0 == r_set_destroy(other));
+
+    ck_assert(0 == r_set_destroy(set_a));
+    ck_assert(0 == r_set_destroy(set_b));
+    ck_assert(0 == r_set_destroy(empty));
+}
+END_TEST
+
+START_TEST (test_r_set_capacity) {
+    static int data[1000];
+    struct r_set* set = r_set_new_with_capacity(&cfg_int_spread, 1000);
+    struct r_set* set2 = r_set_new(&cfg_int_spread);
+    ck_assert(set != NULL);
+    ck_assert(0 == r_set_reserve(set2, 1000));
+
+    int i;
+    for (i = 0; i < 1000; ++i) {
+        data[i] = i;
+        ck_assert(0 == r_set_insert(set, &data[i]));
+        ck_assert(0 == r_set_insert(set2, &data[i]));
+    }
+    ck_assert(1000 == r_set_cardinality(set));
+    ck_assert(1 == r_set_equal(set, set2));
+
+    for (i = 0; i < 1000; ++i) {
+        ck_assert(&data[i] == r_set_contains(set, &data[i]));
+        ck_assert(0 == r_set_remove(set, &data[i]));
+    }
+    ck_assert(0 == r_set_cardinality(set));
+
+    ck_assert(0 == r_set_destroy(set));
+    ck_assert(0 == r_set_destroy(set2));
+}
+END_TEST
+
+START_TEST (test_r_set_union) {
+    static int data[2000];
+    struct r_set* set_a = r_set_new(&cfg_int_spread);
+    struct r_set* set_b = r_set_new_with_capacity(&cfg_int_spread, 20000);
+    struct r_set* dest = r_set_new(&cfg_int_spread);
+
+    int i;
+    for (i = 0; i < 2000; ++i) {
+        data[i] = i;
+        if (i < 1000) {
+            ck_assert(0 == r_set_insert(set_a, &data[i]));
+        }
+        if (i >= 500) {
+            ck_assert(0 == r_set_insert(set_b, &data[i]));
+        }
+    }
+
+    ck_assert(0 == r_set_union(dest, set_a, set_b));
+    ck_assert(2000 == r_set_cardinality(dest));
+    for (i = 0; i < 2000; ++i) {
+        ck_assert(&data[i] == r_set_contains(dest, &data[i]));
+    }
+
+    /* the destination may be one of the operands */
+    ck_assert(0 == r_set_union(set_a, set_a, set_b));
+    ck_assert(1 == r_set_equal(set_a, dest));
+    ck_assert(0 == r_set_union(set_a, set_a, set_a));
+    ck_assert(2000 == r_set_cardinality(set_a));
+
+    struct r_set* other = r_set_new(&cfg_int);
+    ck_assert(-EINVAL == r_set_union(other, set_a, set_b));
+
+    ck_assert(0 == r_set_destroy(set_a));
+    ck_assert(0 == r_set_destroy(set_b));
+    ck_assert(0 == r_set_destroy(dest));
+    ck_assert(0 == r_set_destroy(other));
+}
+END_TEST
+
+START_TEST (test_r_set_intersection) {
+    static int data[2000];
+    struct r_set* set_a = r_set_new(&cfg_int_spread);
+    struct r_set* set_b = r_set_new_with_capacity(&cfg_int_spread, 20000);
+    struct r_set* dest = r_set_new(&cfg_int_spread);
+    struct r_set* result = r_set_new(&cfg_int_spread);
+
+    int i;
+    for (i = 0; i < 2000; ++i) {
+        data[i] = i;
+        if (i < 1000) {
+            ck_assert(0 == r_set_insert(set_a, &data[i]));
+        }
+        if (i >= 500) {
+            ck_assert(0 == r_set_insert(set_b, &data[i]));
+        }
+    }
+
+    /* intersecting with an empty set */
+    ck_assert(0 == r_set_intersection(result, dest, set_a));
+    ck_assert(0 == r_set_cardinality(result));
+    ck_assert(0 == r_set_intersection(dest, set_a, set_b));
+    ck_assert(500 == r_set_cardinality(dest));
+    for (i = 0; i < 2000; ++i) {
+        void* expected = (i >= 500 && i < 1000) ? &data[i] : NULL;
+        ck_assert(expected == r_set_contains(dest, &data[i]));
+    }
+
+    ck_assert(0 == r_set_intersection(result, set_a, set_b));
+    ck_assert(0 == r_set_intersection(dest, set_a, result));
+    ck_assert(0 == r_set_intersection(result, set_a, dest));
+    ck_assert(500 == r_set_cardinality(result));
+    ck_assert(1 == r_set_equal(result, dest));
+
+    /* the destination may be one of the operands */
+    ck_assert(0 == r_set_intersection(set_a, set_a, set_b));
+    ck_assert(1 == r_set_equal(set_a, dest));
+    ck_assert(0 == r_set_intersection(set_b, set_a, set_b));
+    ck_assert(1 == r_set_equal(set_b, dest));
+    ck_assert(0 == r_set_intersection(set_b, set_b, set_b));
+    ck_assert(500 == r_set_cardinality(set_b));
+
+    ck_assert(0 == r_set_destroy(set_a));
+    ck_assert(0 == r_set_destroy(set_b));
+    ck_assert(0 == r_set_destroy(dest));
+    ck_assert(0 == r_set_destroy(result));
+}
+END_TEST
+
+START_TEST (test_r_set_nary) {
+    static int data[4000];
+    struct r_set* sets[4];
+    struct r_set* dest = r_set_new(&cfg_int_spread);
+    struct r_set* result = r_set_new(&cfg_int_spread);
+
+    /* set i holds the multiples of i + 1, in sets of different sizes */
+    int i;
+    int j;
+    for (j = 0; j < 4; ++j) {
+        sets[j] = r_set_new_with_capacity(&cfg_int_spread, 1000 << j);
+    }
+    for (i = 0; i < 4000; ++i) {
+        data[i] = i;
+        for (j = 0; j < 4; ++j) {
+            if (i % (j + 1) == 0) {
+                ck_assert(0 == r_set_insert(sets[j], &data[i]));
+            }
+        }
+    }
+
+    struct r_set const* const* operands = (struct r_set const* const*) sets;
+    ck_assert(0 == r_set_union_n(dest, operands, 4));
+    ck_assert(4000 == r_set_cardinality(dest));
+    ck_assert(0 == r_set_union_n(dest, operands, 0));
+    ck_assert(4000 == r_set_cardinality(dest));
+
+    ck_assert(0 == r_set_intersection_n(result, operands, 4));
+    ck_assert(334 == r_set_cardinality(result));
+    for (i = 0; i < 4000; ++i) {
+        void* expected = (i % 12 == 0) ? &data[i] : NULL;
+        ck_assert(expected == r_set_contains(result, &data[i]));
+    }
+    ck_assert(-EINVAL == r_set_intersection_n(result, operands, 0));
+
+    /* the destination may be one of the operands */
+    ck_assert(0 == r_set_intersection_n(sets[1], operands, 4));
+    ck_assert(1 == r_set_equal(sets[1], result));
+    ck_assert(0 == r_set_union_n(sets[1], operands, 3));
+    ck_assert(1 == r_set_equal(sets[1], dest));
+
+    for (j = 0; j < 4; ++j) {
+        ck_assert(0 == r_set_destroy(sets[j]));
+    }
+    ck_assert(0 == r_set_destroy(dest));
+    ck_assert(0 == r_set_destroy(result));
+}
+END_TEST
+
+START_TEST (test_r_set_exclude) {
+    static int data[2000];
+    struct r_set* set_a = r_set_new(&cfg_int_spread);
+    struct r_set* set_b = r_set_new_with_capacity(&cfg_int_spread, 20000);
+    struct r_set* dest = r_set_new(&cfg_int_spread);
+    struct r_set* result = r_set_new(&cfg_int_spread);
+
+    int i;
+    for (i = 0; i < 2000; ++i) {
+        data[i] = i;
+        if (i < 1000) {
+            ck_assert(0 == r_set_insert(set_a, &data[i]));
+        }
+        if (i >= 500) {
+            ck_assert(0 == r_set_insert(set_b, &data[i]));
+        }
+    }
+
+    /* excluding an empty set */
+    ck_assert(0 == r_set_exclude(result, set_a, dest));
+    ck_assert(1 == r_set_equal(result, set_a));
+    ck_assert(0 == r_set_destroy(result));
+    result = r_set_new(&cfg_int_spread);
+
+    ck_assert(0 == r_set_exclude(dest, set_a, set_b));
+    ck_assert(500 == r_set_cardinality(dest));
+    for (i = 0; i < 2000; ++i) {
+        void* expected = (i < 500) ? &data[i] : NULL;
+        ck_assert(expected == r_set_contains(dest, &data[i]));
+    }
+
+    ck_assert(0 == r_set_exclude(result, set_b, set_a));
+    ck_assert(1000 == r_set_cardinality(result));
+    for (i = 0; i < 2000; ++i) {
+        void* expected = (i >= 1000) ? &data[i] : NULL;
+        ck_assert(expected == r_set_contains(result, &data[i]));
+    }
+    ck_assert(-EINVAL == r_set_exclude(set_b, set_a, set_b));
+
+    /* the destination may be the first operand */
+    ck_assert(0 == r_set_exclude(set_a, set_a, set_b));
+    ck_assert(1 == r_set_equal(set_a, dest));
+    ck_assert(0 == r_set_exclude(set_b, set_b, set_b));
+    ck_assert(0 == r_set_cardinality(set_b));
+
+    ck_assert(0 == r_set_destroy(set_a));
+    ck_assert(0 == r_set_destroy(set_b));
+    ck_assert(0 == r_set_destroy(dest));
+    ck_assert(0 == r_set_destroy(result));
+}
+END_TEST
+
+START_TEST (test_r_set_xor) {
+    static int data[2000];
+    struct r_set* set_a = r_set_new(&cfg_int_spread);
+    struct r_set* set_b = r_set_new_with_capacity(&cfg_int_spread, 20000);
+    struct r_set* dest = r_set_new(&cfg_int_spread);
+    struct r_set* result = r_set_new(&cfg_int_spread);
+
+    int i;
+    for (i = 0; i < 2000; ++i) {
+        data[i] = i;
+        if (i < 1000) {
+            ck_assert(0 == r_set_insert(set_a, &data[i]));
+        }
+        if (i >= 500) {
+            ck_assert(0 == r_set_insert(set_b, &data[i]));
+        }
+    }
+
+    ck_assert(0 == r_set_xor(dest, set_a, set_b));
+    ck_assert(1500 == r_set_cardinality(dest));
+    for (i = 0; i < 2000; ++i) {
+        void* expected = (i < 500 || i >= 1000) ? &data[i] : NULL;
+        ck_assert(expected == r_set_contains(dest, &data[i]));
+    }
+
+    /* the operation is commutative */
+    ck_assert(0 == r_set_xor(result, set_b, set_a));
+    ck_assert(1 == r_set_equal(result, dest));
+
+    /* the destination may be one of the operands */
+    ck_assert(0 == r_set_xor(set_b, set_a, set_b));
+    ck_assert(1 == r_set_equal(set_b, dest));
+    ck_assert(0 == r_set_xor(set_b, set_b, set_a));
+    ck_assert(1500 == r_set_cardinality(set_b));
+    for (i = 0; i < 2000; ++i) {
+        void* expected = (i >= 500) ? &data[i] : NULL;
+        ck_assert(expected == r_set_contains(set_b, &data[i]));
+    }
+    ck_assert(0 == r_set_xor(set_b, set_b, set_b));
+    ck_assert(0 == r_set_cardinality(set_b));
+
+    ck_assert(0 == r_set_destroy(set_a));
+    ck_assert(0 == r_set_destroy(set_b));
+    ck_assert(0 == r_set_destroy(dest));
+    ck_assert(0 == r_set_destroy(result));
+}
+END_TEST
+
+/**
+ * Statistics of the counting allocator
+ */
+struct alloc_stats {
+    size_t live; //!< Number of bytes currently allocated
+    size_t nallocs; //!< Number of allocations performed
+};
+
+static void*
+counting_alloc(
+    void* etc,
+    size_t size
+) {
+    struct alloc_stats* stats = (struct alloc_stats*) etc;
+    stats->live += size;
+    ++stats->nallocs;
+    return malloc(size);
+}
+
+static void
+counting_dealloc(
+    void* etc,
+    void* ptr,
+    size_t size
+) {
+    struct alloc_stats* stats = (struct alloc_stats*) etc;
+    stats->live -= size;
+    free(ptr);
+}
+
+START_TEST (test_r_set_allocator) {
+    static int data[2000];
+    struct alloc_stats stats = { 0, 0 };
+    struct r_set_cfg cfg = cfg_int_spread;
+    cfg.allocf = counting_alloc;
+    cfg.deallocf = counting_dealloc;
+    cfg.alloc_etc = &stats;
+
+    struct r_set* set = r_set_new(&cfg);
+    struct r_set* other = r_set_new(&cfg_int_spread);
+    ck_assert(set != NULL);
+    ck_assert(stats.nallocs > 0);
+
+    int i;
+    for (i = 0; i < 2000; ++i) {
+        data[i] = i;
+        ck_assert(0 == r_set_insert(i < 1000 ? set : other, &data[i]));
+    }
+    for (i = 0; i < 1000; i += 2) {
+        ck_assert(0 == r_set_remove(set, &data[i]));
+    }
+
+    // the allocation functions do not matter for set operations
+    ck_assert(0 == r_set_union(set, set, other));
+    ck_assert(1500 == r_set_cardinality(set));
+    ck_assert(0 == r_set_xor(set, set, other));
+    ck_assert(500 == r_set_cardinality(set));
+
+    ck_assert(0 == r_set_destroy(set));
+    ck_assert(0 == stats.live);
+    ck_assert(0 == r_set_destroy(other));
+}
+END_TEST
+
+START_TEST (test_r_set_destroy_free) {
+    static int data[1000];
+    struct r_set_cfg cfg = cfg_int_spread;
+    cfg.freef = count_free;
+    nfreed = 0;
+
+    struct r_set* set = r_set_new(&cfg);
+    int i;
+    for (i = 0; i < 1000; ++i) {
+        data[i] = i;
+        ck_assert(0 == r_set_insert(set, &data[i]));
+    }
+    ck_assert(0 == r_set_remove(set, &data[0]));
+    ck_assert(1 == nfreed);
+
+    // every remaining element is freed
+    ck_assert(0 == r_set_destroy(set));
+    ck_assert(1000 == nfreed);
+}
+END_TEST
+
+START_TEST (test_r_set_compact) {
+    static int data[8000];
+    struct alloc_stats stats = { 0, 0 };
+    struct r_set_cfg cfg = cfg_int_spread;
+    cfg.allocf = counting_alloc;
+    cfg.deallocf = counting_dealloc;
+    cfg.alloc_etc = &stats;
+
+    struct r_set* set = r_set_new(&cfg);
+    int i;
+    for (i = 0; i < 8000; ++i) {
+        data[i] = i;
+        ck_assert(0 == r_set_insert(set, &data[i]));
+    }
+    for (i = 0; i < 8000; ++i) {
+        if (i % 4) {
+            ck_assert(0 == r_set_remove(set, &data[i]));
+        }
+    }
+
+    // the chunks only holding removed nodes are released
+    size_t live = stats.live;
+    ck_assert(0 == r_set_compact(set));
+    ck_assert(stats.live < live);
+    ck_assert(2000 == r_set_cardinality(set));
+    for (i = 0; i < 8000; ++i) {
+        void* expected = (i % 4) ? NULL : &data[i];
+        ck_assert(expected == r_set_contains(set, &data[i]));
+    }
+
+    // the set remains mutable
+    ck_assert(0 == r_set_insert(set, &data[1]));
+    ck_assert(0 == r_set_remove(set, &data[4]));
+    ck_assert(&data[1] == r_set_contains(set, &data[1]));
+    ck_assert(NULL == r_set_contains(set, &data[4]));
+    ck_assert(2000 == r_set_cardinality(set));
+
+    ck_assert(0 == r_set_destroy(set));
+    ck_assert(0 == stats.live);
+}
+END_TEST
+
+START_TEST (test_r_set_bulk_session) {
+    static int data[4000];
+    struct r_set* set = r_set_new(&cfg_int_spread);
+    struct r_set* other = r_set_new(&cfg_int_spread);
+    int i;
+    for (i = 0; i < 4000; ++i) {
+        data[i] = i;
+        if (i < 2000) {
+            ck_assert(0 == r_set_insert(set, &data[i]));
+        }
+    }
+
+    ck_assert(0 == r_set_begin_bulk(set));
+    ck_assert(0 == r_set_begin_bulk(set));
+    for (i = 2000; i < 4000; ++i) {
+        ck_assert(0 == r_set_insert(set, &data[i]));
+    }
+    for (i = 0; i < 4000; i += 2) {
+        ck_assert(0 == r_set_remove(set, &data[i]));
+    }
+    ck_assert(-EEXIST == r_set_insert(set, &data[1]));
+    ck_assert(-EEXIST == r_set_remove(set, &data[0]));
+
+    // the set may be queried and used as an operand, but not modified else
+    ck_assert(2000 == r_set_cardinality(set));
+    for (i = 0; i < 4000; ++i) {
+        void* expected = (i % 2) ? &data[i] : NULL;
+        ck_assert(expected == r_set_contains(set, &data[i]));
+    }
+    ck_assert(0 == r_set_union(other, other, set));
+    ck_assert(-EBUSY == r_set_union(set, set, other));
+    ck_assert(-EBUSY == r_set_reserve(set, 10000));
+    ck_assert(-EBUSY == r_set_freeze(set));
+
+    // the contents stay the same once the trees are rebalanced
+    r_set_end_bulk(set);
+    r_set_end_bulk(set);
+    ck_assert(r_set_equal(set, other));
+    ck_assert(0 == r_set_insert(set, &data[0]));
+    ck_assert(0 == r_set_union(set, set, other));
+    ck_assert(2001 == r_set_cardinality(set));
+
+    ck_assert(0 == r_set_freeze(other));
+    ck_assert(-EPERM == r_set_begin_bulk(other));
+
+    ck_assert(0 == r_set_destroy(set));
+    ck_assert(0 == r_set_destroy(other));
+}
+END_TEST
+
+/**
+ * Count the elements fed to it in the size_t `dest`
+ */
+static int
+count_element(
+    void* dest,
+    void const* data
+) {
+    ++*((size_t*) dest);
+    return 0;
+}
+
+/**
+ * Select even ints
+ */
+static int
+is_even(
+    void const* data,
+    void* etc
+) {
+    return *((int*) data) % 2 == 0;
+}
+
+/**
+ * Number of copies made by copy_int() and released by free_int()
+ */
+static size_t ncopies;
+
+static void*
+copy_int(
+    void* data
+) {
+    int* copy = malloc(sizeof(*copy));
+    if (copy) {
+        *copy = *((int*) data);
+        ++ncopies;
+    }
+    return copy;
+}
+
+static void
+free_int(
+    void* data
+) {
+    --ncopies;
+    free(data);
+}
+
+START_TEST (test_r_set_xor_copies) {
+    static int data[1500];
+    struct r_set_cfg cfg = cfg_int_spread;
+    cfg.copyf = copy_int;
+    cfg.freef = free_int;
+    ncopies = 0;
+
+    struct r_set* set_a = r_set_new(&cfg);
+    struct r_set* set_b = r_set_new(&cfg);
+    int i;
+    for (i = 0; i < 1500; ++i) {
+        data[i] = i;
+        if (i < 1000) {
+            ck_assert(0 == r_set_insert(set_a, &data[i]));
+        }
+        if (i >= 500) {
+            ck_assert(0 == r_set_insert(set_b, &data[i]));
+        }
+    }
+    ck_assert(2000 == ncopies);
+
+    // each element merged into `set_a` is copied exactly once
+    ck_assert(0 == r_set_xor(set_a, set_a, set_b));
+    ck_assert(1000 == r_set_cardinality(set_a));
+    ck_assert(2000 == ncopies);
+
+    ck_assert(0 == r_set_destroy(set_a));
+    ck_assert(0 == r_set_destroy(set_b));
+    ck_assert(0 == ncopies);
+}
+END_TEST
+
+/**
+ * Allocate memory, failing once the number of allocations passed as `etc` is
+ * used up
+ */
+static void*
+limited_alloc(
+    void* etc,
+    size_t size
+) {
+    size_t* budget = (size_t*) etc;
+    if (!*budget) {
+        return NULL;
+    }
+    --*budget;
+    return malloc(size);
+}
+
+START_TEST (test_r_set_from_array_failure) {
+    static int data[2000];
+    static void* elems[2000];
+    int i;
+    for (i = 0; i < 2000; ++i) {
+        data[i] = i;
+        elems[i] = &data[i];
+    }
+
+    size_t budget;
+    struct r_set_cfg cfg = cfg_int_spread;
+    cfg.copyf = copy_int;
+    cfg.freef = free_int;
+    cfg.allocf = limited_alloc;
+    cfg.alloc_etc = &budget;
+
+    // fail at each allocation in turn, the copies made so far are released
+    struct r_set* set = NULL;
+    size_t limit;
+    for (limit = 0; !set; ++limit) {
+        budget = limit;
+        ncopies = 0;
+        set = r_set_from_array(&cfg, elems, 2000);
+        if (!set) {
+            ck_assert(0 == ncopies);
+        }
+    }
+    ck_assert(limit > 3);
+    ck_assert(2000 == r_set_cardinality(set));
+    ck_assert(2000 == ncopies);
+
+    ck_assert(0 == r_set_destroy(set));
+    ck_assert(0 == ncopies);
+}
+END_TEST
+
+START_TEST (test_r_set_freeze) {
+    static int data[4000];
+    struct alloc_stats stats = { 0, 0 };
+    struct r_set_cfg cfg = cfg_int_spread;
+    cfg.freef = count_free;
+    cfg.allocf = counting_alloc;
+    cfg.deallocf = counting_dealloc;
+    cfg.alloc_etc = &stats;
+    nfreed = 0;
+
+    struct r_set* set = r_set_new(&cfg);
+    int i;
+    for (i = 0; i < 4000; ++i) {
+        data[i] = i;
+        if (i < 2000) {
+            ck_assert(0 == r_set_insert(set, &data[i]));
+        }
+    }
+    ck_assert(0 == r_set_remove(set, &data[0]));
+    ck_assert(1 == nfreed);
+
+    ck_assert(0 == r_set_freeze(set));
+    ck_assert(0 == r_set_freeze(set));
+    ck_assert(1999 == r_set_cardinality(set));
+    for (i = 0; i < 4000; ++i) {
+        void* expected = (i > 0 && i < 2000) ? &data[i] : NULL;
+        ck_assert(expected == r_set_contains(set, &data[i]));
+    }
+
+    size_t cnt = 0;
+    ck_assert(0 == r_set_select(set, NULL, NULL, count_element, &cnt));
+    ck_assert(1999 == cnt);
+    cnt = 0;
+    ck_assert(0 == r_set_select(set, is_even, NULL, count_element, &cnt));
+    ck_assert(999 == cnt);
+
+    // a frozen set can not be modified
+    ck_assert(-EPERM == r_set_insert(set, &data[2000]));
+    ck_assert(-EPERM == r_set_remove(set, &data[1]));
+    ck_assert(-EPERM == r_set_reserve(set, 10000));
+    ck_assert(-EPERM == r_set_union(set, set, set));
+    ck_assert(1999 == r_set_cardinality(set));
+    ck_assert(1 == nfreed);
+
+    // the elements are freed along with the set
+    ck_assert(0 == r_set_destroy(set));
+    ck_assert(2000 == nfreed);
+    ck_assert(0 == stats.live);
+}
+END_TEST
+
+START_TEST (test_r_set_frozen_operations) {
+    static int data[2000];
+    struct r_set* set_a = r_set_new(&cfg_int_spread);
+    struct r_set* set_b = r_set_new(&cfg_int_spread);
+    struct r_set* frozen_a = r_set_new(&cfg_int_spread);
+    struct r_set* frozen_b = r_set_new_with_capacity(&cfg_int_spread, 20000);
+    struct r_set* dest = r_set_new(&cfg_int_spread);
+    struct r_set* result = r_set_new(&cfg_int_spread);
+
+    int i;
+    for (i = 0; i < 2000; ++i) {
+        data[i] = i;
+        if (i < 1000) {
+            ck_assert(0 == r_set_insert(set_a, &data[i]));
+            ck_assert(0 == r_set_insert(frozen_a, &data[i]));
+        }
+        if (i >= 500) {
+            ck_assert(0 == r_set_insert(set_b, &data[i]));
+            ck_assert(0 == r_set_insert(frozen_b, &data[i]));
+        }
+    }
+    ck_assert(0 == r_set_freeze(frozen_a));
+    ck_assert(0 == r_set_freeze(frozen_b));
+
+    /* frozen sets compare like the sets they were built from */
+    ck_assert(1 == r_set_equal(frozen_a, set_a));
+    ck_assert(1 == r_set_equal(set_b, frozen_b));
+    ck_assert(0 == r_set_equal(frozen_a, frozen_b));
+    ck_assert(0 == r_set_is_subset(frozen_a, set_b));
+    ck_assert(0 == r_set_disjoint(frozen_a, frozen_b));
+    ck_assert(500 == r_set_intersection_cardinality(set_a, frozen_b));
+    ck_assert(1500 == r_set_xor_cardinality(frozen_a, frozen_b));
+
+    /* frozen sets may be operands of any operation */
+    ck_assert(0 == r_set_union(dest, frozen_a, frozen_b));
+    ck_assert(2000 == r_set_cardinality(dest));
+    ck_assert(0 == r_set_intersection(result, frozen_a, set_b));
+    ck_assert(500 == r_set_cardinality(result));
+    ck_assert(1 == r_set_is_subset(result, frozen_a));
+    ck_assert(1 == r_set_is_subset(result, frozen_b));
+    ck_assert(0 == r_set_destroy(result));
+    result = r_set_new(&cfg_int_spread);
+
+    ck_assert(0 == r_set_exclude(result, frozen_b, frozen_a));
+    ck_assert(1000 == r_set_cardinality(result));
+    for (i = 0; i < 2000; ++i) {
+        void* expected = (i >= 1000) ? &data[i] : NULL;
+        ck_assert(expected == r_set_contains(result, &data[i]));
+    }
+    ck_assert(0 == r_set_destroy(result));
+    result = r_set_new(&cfg_int_spread);
+
+    struct r_set const* operands[] = { frozen_a, set_b, dest };
+    ck_assert(0 == r_set_intersection_n(result, operands, 3));
+    ck_assert(500 == r_set_cardinality(result));
+
+    /* only the destination of an operation must not be frozen */
+    ck_assert(0 == r_set_intersection(set_b, set_b, frozen_a));
+    ck_assert(1 == r_set_equal(set_b, result));
+    ck_assert(0 == r_set_xor(set_a, set_a, frozen_b));
+    ck_assert(1500 == r_set_cardinality(set_a));
+    ck_assert(0 == r_set_exclude(set_a, set_a, frozen_b));
+    ck_assert(500 == r_set_cardinality(set_a));
+    ck_assert(-EPERM == r_set_xor(frozen_a, frozen_a, set_b));
+    ck_assert(-EPERM == r_set_intersection_n(frozen_a, operands, 3));
+
+    ck_assert(0 == r_set_destroy(set_a));
+    ck_assert(0 == r_set_destroy(set_b));
+    ck_assert(0 == r_set_destroy(frozen_a));
+    ck_assert(0 == r_set_destroy(frozen_b));
+    ck_assert(0 == r_set_destroy(dest));
+    ck_assert(0 == r_set_destroy(result));
+}
+END_TEST
+
 Suite*
 suite_set_create(void) {
     Suite* s;
     TCase* case_cardinality;
     TCase* case_equality;
+    TCase* case_operations;
+    TCase* case_allocation;
+    TCase* case_freezing;
 
     s = suite_create("Set");
 
     /* Test case creation */
     case_cardinality  = tcase_create("Cardinality");
     case_equality     = tcase_create("Equality");
+    case_operations   = tcase_create("Operations");
+    case_allocation   = tcase_create("Allocation");
+    case_freezing     = tcase_create("Freezing");
 
     /* test adding to test cases */
     tcase_add_test(case_cardinality, test_r_set_cardinality);
+    tcase_add_test(case_cardinality, test_r_set_capacity);
+    tcase_add_test(case_cardinality, test_r_set_from_array);
+    tcase_add_test(case_cardinality, test_r_set_operation_cardinality);
 
     tcase_add_test(case_equality, test_r_set_equal);
+    tcase_add_test(case_equality, test_r_set_is_subset);
+    tcase_add_test(case_equality, test_r_set_disjoint);
+
+    tcase_add_test(case_operations, test_r_set_union);
+    tcase_add_test(case_operations, test_r_set_intersection);
+    tcase_add_test(case_operations, test_r_set_nary);
+    tcase_add_test(case_operations, test_r_set_exclude);
+    tcase_add_test(case_operations, test_r_set_xor);
+
+    tcase_add_test(case_allocation, test_r_set_allocator);
+    tcase_add_test(case_allocation, test_r_set_destroy_free);
+    tcase_add_test(case_allocation, test_r_set_xor_copies);
+    tcase_add_test(case_allocation, test_r_set_from_array_failure);
+    tcase_add_test(case_allocation, test_r_set_compact);
+    tcase_add_test(case_allocation, test_r_set_bulk_session);
+
+    tcase_add_test(case_freezing, test_r_set_freeze);
+    tcase_add_test(case_freezing, test_r_set_frozen_operations);
 
     /* Adding test cases to suite */
     suite_add_tcase(s, case_cardinality);
     suite_add_tcase(s, case_equality);
+    suite_add_tcase(s, case_operations);
+    suite_add_tcase(s, case_allocation);
+    suite_add_tcase(s, case_freezing);
 
     return s;
 }
@@ -5,6 +5,7 @@
 #include <stdint.h>
 
 static r_hash hashf(void const*);
+static r_hash hashf_spread(void const*);
 static int cmpf(void const*, void const*);
 void const* copyf(void const*);
 
@@ -13,14 +14,42 @@ struct r_set_cfg cfg_int = {
     hashf,
     cmpf,
     copyf,
+    NULL,
+    NULL,
+    NULL,
     NULL
 };
 
+struct r_set_cfg cfg_int_spread = {
+    hashf_spread,
+    cmpf,
+    copyf,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+struct pool pool;
+
+void setup_pool(void) {
+    pool_init(&pool, &cfg_int);
+}
+
+void teardown_pool(void) {
+    pool_destroy(&pool);
+}
+
 
 static r_hash hashf(void const* d) {
     return SIZE_MAX / (*((int*) d)/2+1) ;
 }
 
+static r_hash hashf_spread(void const* d) {
+    // spread the values over the whole range of hashes (Fibonacci hashing)
+    return ((r_hash) *((int*) d)) * (r_hash) 0x9E3779B97F4A7C15ull;
+}
+
 static int cmpf(void const* a, void const* b) {
     return *((int*) a) == *((int*) b);
 }
@@ -14,8 +14,21 @@
 #define __SET_CFG__
 
 #include "libreset/set.h"
+#include "pool.h"
 
 extern struct r_set_cfg cfg_int;
+extern struct r_set_cfg cfg_int_spread;
+
+/**
+ * Pool for tests operating on linked lists and AVLs directly
+ *
+ * Test cases using the pool must set it up via tcase_add_checked_fixture(),
+ * passing setup_pool() and teardown_pool().
+ */
+extern struct pool pool;
+
+void setup_pool(void);
+void teardown_pool(void);
 
 #endif // __SET_CFG__
 
@@ -4,8 +4,10 @@
 /*
  * Include test files below
  */
+#include "pool/pool_tests.c"
 #include "ll/ll_test.c"
 #include "avl/avl_tests.c"
+#include "flat/flat_tests.c"
 #include "ht/ht_tests.c"
 #include "set/set_tests.c"
 
@@ -24,8 +26,10 @@ main(void) {
      * Insert suite creator functions here
      */
     suite_creator_f suite_funcs[] = {
+        suite_pool_create,
         suite_ll_create,
         suite_avl_create,
+        suite_flat_create,
         suite_ht_create,
         suite_set_create
     };